@@ -0,0 +1,195 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file bench_memory.c
+ * @brief Throughput of the memory.c kernels next to libc, as CSV
+ *
+ * Runs my_memcopy, my_memmove in both overlap directions, my_memset,
+ * my_memzero and my_reverse on every power of two size from 1 byte to
+ * BENCH_MAX_SIZE, and for each size on every pair of source and
+ * destination offsets from 0 to BENCH_ALIGN - 1. Each case is repeated
+ * until it has run for BENCH_MIN_SECONDS, and the same case is timed
+ * with the libc counterpart. One CSV line per case goes to stdout,
+ * progress goes to stderr. Built and run by "make bench-memory", HOST only.
+ *
+ * @author Oksana Vynokurova
+ * @date 11/2024
+ *
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "memory.h"
+
+#ifndef BENCH_MAX_SIZE
+  #define BENCH_MAX_SIZE (1024UL * 1024UL * 1024UL)
+#endif
+
+#ifndef BENCH_ALIGN
+  #define BENCH_ALIGN (8)
+#endif
+
+#ifndef BENCH_MIN_SECONDS
+  #define BENCH_MIN_SECONDS (0.01)
+#endif
+
+/* Distance between source and destination of the overlapping moves */
+#define BENCH_OVERLAP_SHIFT (BENCH_ALIGN + 7)
+
+#define BENCH_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+typedef enum
+{
+  BENCH_COPY,
+  BENCH_MOVE_FORWARD,    /* dst below src */
+  BENCH_MOVE_BACKWARD,   /* dst above src */
+  BENCH_SET,
+  BENCH_ZERO,
+  BENCH_REVERSE,
+  BENCH_OPS
+} bench_op_t;
+
+static const char * bench_names[BENCH_OPS] =
+{
+  "my_memcopy", "my_memmove_fwd", "my_memmove_back",
+  "my_memset", "my_memzero", "my_reverse"
+};
+
+static uint8_t * bench_src;
+static uint8_t * bench_dst;
+
+static double bench_now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/* libc has no reverse, that column stays empty */
+static void bench_run(bench_op_t op, uint8_t use_libc, size_t length,
+                      size_t src_off, size_t dst_off)
+{
+  uint8_t * src = bench_src + src_off;
+  uint8_t * dst = bench_dst + dst_off;
+  uint8_t * low = bench_src + src_off;
+  uint8_t * high = bench_src + BENCH_OVERLAP_SHIFT + dst_off;
+
+  switch (op)
+  {
+    case BENCH_COPY:
+      use_libc ? (void) memcpy(dst, src, length) : (void) my_memcopy(src, dst, length);
+      break;
+    case BENCH_MOVE_FORWARD:
+      use_libc ? (void) memmove(low, high, length) : (void) my_memmove(high, low, length);
+      break;
+    case BENCH_MOVE_BACKWARD:
+      use_libc ? (void) memmove(high, low, length) : (void) my_memmove(low, high, length);
+      break;
+    case BENCH_SET:
+      use_libc ? (void) memset(dst, 0xA5, length) : (void) my_memset(dst, length, 0xA5);
+      break;
+    case BENCH_ZERO:
+      use_libc ? (void) memset(dst, 0, length) : (void) my_memzero(dst, length);
+      break;
+    default:
+      my_reverse(dst, length);
+      break;
+  }
+  BENCH_BARRIER();
+}
+
+/* Repeats a case, doubling the count until it runs long enough */
+static double bench_gbps(bench_op_t op, uint8_t use_libc, size_t length,
+                         size_t src_off, size_t dst_off)
+{
+  size_t reps = 1;
+  size_t i;
+  double start;
+  double elapsed;
+
+  bench_run(op, use_libc, length, src_off, dst_off);
+  while (1)
+  {
+    start = bench_now();
+    for (i = 0; i < reps; i++)
+    {
+      bench_run(op, use_libc, length, src_off, dst_off);
+    }
+    elapsed = bench_now() - start;
+    if (elapsed >= BENCH_MIN_SECONDS)
+    {
+      return (double) length * (double) reps / elapsed / 1e9;
+    }
+    reps *= 2;
+  }
+}
+
+int main(void)
+{
+  size_t bytes = BENCH_MAX_SIZE + BENCH_OVERLAP_SHIFT + 2 * BENCH_ALIGN;
+  size_t length;
+  size_t src_off;
+  size_t dst_off;
+  bench_op_t op;
+  double mine;
+  double libc;
+
+  if ((posix_memalign((void **) &bench_src, 4096, bytes) != 0) ||
+      (posix_memalign((void **) &bench_dst, 4096, bytes) != 0))
+  {
+    fprintf(stderr, "bench_memory: cannot allocate 2 x %lu bytes\n", (unsigned long) bytes);
+    return 1;
+  }
+  /* fault every page in before timing */
+  memset(bench_src, 0x5A, bytes);
+  memset(bench_dst, 0xC3, bytes);
+
+  printf("function,size,src_offset,dst_offset,gbps,libc_gbps,ratio\n");
+  for (length = 1; length <= BENCH_MAX_SIZE; length *= 2)
+  {
+    fprintf(stderr, "bench_memory: %lu bytes\n", (unsigned long) length);
+    for (op = BENCH_COPY; op < BENCH_OPS; op++)
+    {
+      for (src_off = 0; src_off < BENCH_ALIGN; src_off++)
+      {
+        /* set, zero and reverse have no source */
+        if ((src_off != 0) && (op >= BENCH_SET))
+        {
+          break;
+        }
+        for (dst_off = 0; dst_off < BENCH_ALIGN; dst_off++)
+        {
+          mine = bench_gbps(op, 0, length, src_off, dst_off);
+          if (op == BENCH_REVERSE)
+          {
+            printf("%s,%lu,%lu,%lu,%.3f,,\n", bench_names[op], (unsigned long) length,
+                   (unsigned long) src_off, (unsigned long) dst_off, mine);
+          }
+          else
+          {
+            libc = bench_gbps(op, 1, length, src_off, dst_off);
+            printf("%s,%lu,%lu,%lu,%.3f,%.3f,%.3f\n", bench_names[op], (unsigned long) length,
+                   (unsigned long) src_off, (unsigned long) dst_off, mine, libc, mine / libc);
+          }
+        }
+      }
+    }
+    fflush(stdout);
+  }
+
+  free(bench_src);
+  free(bench_dst);
+  return 0;
+}
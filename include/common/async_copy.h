@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file async_copy.h
+ * @brief Copies and fills that run in the background on worker threads
+ *
+ * A request is submitted with async_copy_submit() or async_fill_submit()
+ * and returns a handle right away. Worker threads split the request into
+ * chunks and move them with my_memcopy/my_memset. The caller can poll or
+ * wait on the handle, or get a callback once the last chunk is done.
+ * This is the host side counterpart of handing a transfer to the MSP432
+ * uDMA controller, and is only built for the HOST platform.
+ *
+ * @author Oksana Vynokurova
+ * @date 11/2024
+ *
+ */
+#ifndef __ASYNC_COPY_H__
+#define __ASYNC_COPY_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/* Chunk size used when async_copy_init gets 0 */
+#define ASYNC_DEFAULT_CHUNK_B (256 * 1024)
+
+/* Upper limit of worker threads */
+#define ASYNC_MAX_THREADS (16)
+
+/* Handle of one submitted request */
+typedef struct async_request * async_handle_t;
+
+/* Called by a worker thread once all chunks of a request are done */
+typedef void (*async_callback_t)(async_handle_t handle, void * context);
+
+/**
+ * @brief Starts the worker threads
+ *
+ * Requests submitted before this call, or after async_copy_shutdown,
+ * are done right away on the calling thread.
+ *
+ * @param uint8_t threads - Number of worker threads, 1 to ASYNC_MAX_THREADS
+ * @param size_t chunk_bytes - Bytes one worker moves at a time,
+ *                             0 for ASYNC_DEFAULT_CHUNK_B
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if the engine runs already or
+ *           no thread could be started
+ */
+int8_t async_copy_init(uint8_t threads, size_t chunk_bytes);
+
+/**
+ * @brief Finishes all queued requests and stops the worker threads
+ */
+void async_copy_shutdown(void);
+
+/**
+ * @brief Queues a copy of (length) bytes from (src) to (dst)
+ *
+ * The regions must not overlap, the same as for my_memcopy.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param async_callback_t callback - Called when done, may be NULL
+ * @param void * context - Passed to the callback
+ *
+ * @return - handle of the request, or NULL if there is no memory for it
+ */
+async_handle_t async_copy_submit(uint8_t * src, uint8_t * dst, size_t length,
+                                 async_callback_t callback, void * context);
+
+/**
+ * @brief Queues a fill of (length) bytes at (dst) with (value)
+ *
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to set
+ * @param uint8_t value - Value to write
+ * @param async_callback_t callback - Called when done, may be NULL
+ * @param void * context - Passed to the callback
+ *
+ * @return - handle of the request, or NULL if there is no memory for it
+ */
+async_handle_t async_fill_submit(uint8_t * dst, size_t length, uint8_t value,
+                                 async_callback_t callback, void * context);
+
+/**
+ * @brief Checks if a request is done, without blocking
+ *
+ * @param async_handle_t handle - Handle from a submit call
+ *
+ * @return - 1 if the request and its callback are done, 0 otherwise
+ */
+uint8_t async_copy_poll(async_handle_t handle);
+
+/**
+ * @brief Blocks until a request and its callback are done
+ *
+ * @param async_handle_t handle - Handle from a submit call
+ */
+void async_copy_wait(async_handle_t handle);
+
+/**
+ * @brief Waits for a request and gives its handle back
+ *
+ * Every handle has to be released exactly once, also after a callback.
+ *
+ * @param async_handle_t handle - Handle from a submit call
+ */
+void async_copy_release(async_handle_t handle);
+
+#endif /* __ASYNC_COPY_H__ */
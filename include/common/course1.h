@@ -26,10 +26,39 @@
 #define MEM_SET_SIZE_W  (8)
 #define MEM_ZERO_LENGTH (16)
 
+#define MEM_SWEEP_SIZE_W     (128)
+#define MEM_SWEEP_SIZE_B     (512)
+#define MEM_SWEEP_MAX_LENGTH (160)
+#define MEM_SWEEP_ALIGN      (16)
+
+#define ARENA_TEST_SIZE_W    (64)
+#define POOL_TEST_BLOCKS     (4)
+#define SG_TEST_DESCS        (6)
+#define THREAD_TEST_THREADS  (4)
+#define THREAD_TEST_BLOCKS   (256)
+#define THREAD_TEST_ROUNDS   (3)
+#define ASYNC_TEST_SIZE_B    (4096)
+#define ASYNC_TEST_CHUNK_B   (512)
+#define ASYNC_TEST_THREADS   (2)
+#define PARALLEL_TEST_SIZE_B (64 * 1024)
+#define PARALLEL_TEST_THREADS (4)
+#define RING_TEST_CAPACITY   (64)
+#define RING_TEST_STREAM_B   (64 * 1024)
+#define LARGE_TEST_SIZE_W    (3 * 1024 * 1024 / 4)
+#define RESIZE_TEST_WORDS    (200)
+#define RESIZE_TEST_GROWN_W  (64 * 1024 * 1024 / 4)
+#define ROTATE_TEST_SIZE_B   (1200)
+#define ROTATE_TEST_LARGE_B  (3 * 1024 * 1024 + 333)
+#define ITOA_TEST_STEP       (858993)
+#define INT64_TEST_VALUES    (2000)
+#define BATCH_TEST_VALUES    (200)
+#define BATCH_TEST_MAX_B     (34)
+#define BATCH_TEST_TEXT_B    (BATCH_TEST_VALUES * BATCH_TEST_MAX_B)
+
 #define TEST_MEMMOVE_LENGTH (16)
 #define TEST_ERROR          (1)
 #define TEST_NO_ERROR       (0)
-#define TESTCOUNT           (8)
+#define TESTCOUNT           (31)
 
 #define BASE_16 (16)
 #define BASE_10 (10)
@@ -100,6 +129,18 @@ int8_t test_memmove2();
  */
 int8_t test_memmove3();
 
+/**
+ * @brief function to test overlapped memmove in both directions
+ * 
+ * This function calls my_memmove for all lengths up to MEM_SWEEP_MAX_LENGTH
+ * with source and destination overlapping by every distance below 
+ * MEM_SWEEP_ALIGN, moving the data both up and down in memory. It checks
+ * the whole buffer after each move.
+ *
+ * @return void
+ */
+int8_t test_memmove_overlap();
+
 /**
  * @brief function to test the memcopy functionality
  * 
@@ -110,6 +151,18 @@ int8_t test_memmove3();
  */
 int8_t test_memcopy();
 
+/**
+ * @brief function to test the memcopy kernels on every alignment
+ * 
+ * This function calls my_memcopy for all lengths up to MEM_SWEEP_MAX_LENGTH
+ * and all source/destination offsets below MEM_SWEEP_ALIGN. It checks that
+ * the copied bytes are correct and that no byte around the destination
+ * was touched.
+ *
+ * @return void
+ */
+int8_t test_memcopy_align();
+
 /**
  * @brief function to test the memset and memzero functionality
  * 
@@ -120,6 +173,18 @@ int8_t test_memcopy();
  */
 int8_t test_memset();
 
+/**
+ * @brief function to test the memset kernels on every alignment
+ * 
+ * This function calls my_memset for all lengths up to MEM_SWEEP_MAX_LENGTH
+ * and all offsets below MEM_SWEEP_ALIGN, once with the default streaming
+ * threshold and once with streaming forced down to 64 byte fills. It checks
+ * that no byte around the block was touched.
+ *
+ * @return void
+ */
+int8_t test_memset_align();
+
 /**
  * @brief function to test the reverse functionality
  * 
@@ -130,5 +195,235 @@ int8_t test_memset();
  */
 int8_t test_reverse();
 
+/**
+ * @brief function to test the reverse functionality on every length
+ * 
+ * This function calls my_reverse for all lengths up to MEM_SWEEP_SIZE_B - 
+ * MEM_SWEEP_ALIGN at a few offsets, so that every block width of the
+ * reverse kernels and every odd middle is reached. It checks the whole
+ * buffer after each call.
+ *
+ * @return void
+ */
+int8_t test_reverse_lengths();
+
+/**
+ * @brief function to test the arena allocator
+ * 
+ * This function sets up an arena of ARENA_TEST_SIZE_W words and checks
+ * that reserve_words hands out consecutive blocks, that arena_rewind() and
+ * free_words of the last block give memory back, that an exhausted arena
+ * returns a Null Pointer and that arena_reset() empties it.
+ *
+ * @return void
+ */
+int8_t test_arena();
+
+/**
+ * @brief function to test the pool allocator
+ * 
+ * This function attaches a pool of POOL_TEST_BLOCKS blocks of 
+ * MEM_SET_SIZE_W words and checks that reserve_words takes blocks from it
+ * until it is empty and then falls back to the heap, that free_words gives
+ * blocks back and that the occupancy counters follow.
+ *
+ * @return void
+ */
+int8_t test_pool();
+
+/**
+ * @brief function to test reserve_words and free_words from many threads
+ * 
+ * On the HOST platform this function starts THREAD_TEST_THREADS threads
+ * that each reserve THREAD_TEST_BLOCKS blocks of various sizes and fill
+ * them. Every block is then checked and freed by a different thread, which
+ * exercises the cross-thread frees of the thread cache. It passes trivially
+ * on platforms without threads and with a build-time arena.
+ *
+ * @return void
+ */
+int8_t test_words_threads();
+
+/**
+ * @brief function to test the allocation statistics
+ * 
+ * In an instrumented build this function reserves and frees a block and
+ * sorts a small array with sort_merge, and checks that the call counters,
+ * the bytes in flight, the peak and the size histogram follow. It passes
+ * trivially in a build without instrumentation.
+ *
+ * @return void
+ */
+int8_t test_instrument();
+
+/**
+ * @brief function to test the scatter/gather move
+ * 
+ * This function hands my_memmove_sg a shuffled list of descriptors. Some
+ * of them continue each other and can be merged, one of them overlaps its
+ * own destination. It checks the moved data, the byte count and that
+ * every descriptor is marked done.
+ *
+ * @return void
+ */
+int8_t test_memmove_sg();
+
+/**
+ * @brief function to test the asynchronous copy engine
+ *
+ * Submits a copy and a fill that are split into several chunks, waits
+ * for one and polls the other, and checks that each callback ran once.
+ * Only runs on the HOST platform.
+ *
+ * @return void
+ */
+int8_t test_async_copy();
+
+/**
+ * @brief function to test the multi-threaded copy and fill
+ *
+ * Copies and fills a buffer with my_memcopy_parallel, my_memset_parallel
+ * and my_memzero_parallel at odd offsets, checks that the bytes around
+ * the range stay untouched, and runs my_memcopy in the automatic mode.
+ *
+ * @return void
+ */
+int8_t test_memory_parallel();
+
+/**
+ * @brief function to test my_mismatch, my_memcmp, my_memchr and my_memrchr
+ *
+ * Sweeps lengths and start offsets, places differences and search values
+ * at the first, a middle and the last byte, and right outside the range
+ * where they must not be found.
+ *
+ * @return void
+ */
+int8_t test_memcmp_search();
+
+/**
+ * @brief function to test the fused copy and checksum functions
+ *
+ * Checks CRC-32, CRC-32C and Adler-32 against their standard check values
+ * for "123456789", then copies a longer buffer in one call and in two
+ * chained calls split at every offset, and checks that the copy is right
+ * and that both ways give the same checksums.
+ *
+ * @return void
+ */
+int8_t test_memcopy_checksum();
+
+/**
+ * @brief function to test my_bswap16, my_bswap32 and my_bswap64
+ *
+ * Swaps arrays of every count up to the sweep length at odd offsets,
+ * out of place and in place, and checks every element and the guard
+ * bytes after the array.
+ *
+ * @return void
+ */
+int8_t test_bswap();
+
+/**
+ * @brief function to test the single producer/consumer ring buffer
+ *
+ * Writes and reads blocks of changing sizes so the indexes wrap around
+ * many times, uses the peek/commit calls for zero-copy access, and on
+ * the HOST streams data from a producer thread to the test thread.
+ *
+ * @return void
+ */
+int8_t test_ring_buffer();
+
+/**
+ * @brief function to test reference counted buffer slices
+ *
+ * Takes slices and slices of slices of one block, checks that they point
+ * into it without copies, runs find_mean on a slice, releases the parent
+ * first and checks the block lives until the last slice is released.
+ *
+ * @return void
+ */
+int8_t test_slices();
+
+/**
+ * @brief function to test aligned and large allocations
+ *
+ * Checks reserve_words_aligned for alignments from 4 to 256 bytes and
+ * odd sizes, and reserve_words_large with every combination of flags.
+ * Each block is written end to end before it is freed.
+ *
+ * @return void
+ */
+int8_t test_reserve_aligned();
+
+/**
+ * @brief function to test growing blocks and word buffers
+ *
+ * Grows reserve_words blocks with resize_words and checks the kept
+ * words, fills a word buffer a few words at a time, and on the host
+ * grows a mapped block to 64 MB and a word buffer past
+ * MEMORY_WORDBUF_LARGE_WORDS.
+ *
+ * @return void
+ */
+int8_t test_resize_words();
+
+/**
+ * @brief function to test in place rotation
+ *
+ * Rotates buffers by shifts that take the buffered path and the
+ * reversal or block swap path, including 0 and shifts of more than the
+ * length, and checks every byte. The host also rotates a few MB.
+ *
+ * @return void
+ */
+int8_t test_rotate();
+
+/**
+ * @brief function to test my_itoa in every base
+ *
+ * Converts the limits, powers of the base and their neighbours, and a
+ * sweep over the whole int32_t range in every base from 2 to 36, and
+ * compares string and length with a plain division loop.
+ *
+ * @return void
+ */
+int8_t test_itoa();
+
+/**
+ * @brief function to test the checked my_atoi
+ *
+ * Converts back what my_itoa writes in every base, long strings with
+ * leading zeros that take the 8 and 16 digit steps, the limits and one
+ * past them, and strings with a bad character, which my_atoi still
+ * converts the old lenient way.
+ *
+ * @return void
+ */
+int8_t test_atoi();
+
+/**
+ * @brief function to test the 64 bit conversions
+ *
+ * Writes and reads back the limits, the values around the borders of
+ * the 32 bit chunks, powers of every base and pseudo-random values of
+ * every magnitude, and checks the 64 bit overflow limits.
+ *
+ * @return void
+ */
+int8_t test_int64();
+
+/**
+ * @brief function to test my_itoa_batch
+ *
+ * Writes the same values in several bases into buffers of several
+ * sizes, and checks that the pieces put together are the text my_itoa
+ * gives, that no value is cut and that nothing is written past a buffer.
+ *
+ * @return void
+ */
+int8_t test_itoa_batch();
+
 #endif /* __COURSE1_H__ */
 
@@ -22,6 +22,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+/* Highest base: digits are '0' - '9', then 'A' - 'Z' */
+#define DATA_MAX_BASE (36)
+
 /**
  * @brief Convert data from a standard integer type into an ASCII string
  *
@@ -30,8 +33,9 @@
  *
  * All operations need to be performed using pointer arithmetic, not array indexing
  * The number you wish to convert is passed in as a signed 32-bit integer.
- * You should be able to support bases 2 to 16 by specifying the integer value 
+ * You should be able to support bases 2 to 36 by specifying the integer value 
  *	of the base you wish to convert to (base).
+ * Digits above 9 are written as the upper case letters 'A' - 'Z'.
  * Copy the converted character string to the uint8_t* pointer passed in as 
  *	a parameter (ptr)
  * The signed 32-bit number will have a maximum string size (Hint: Think base 2).
@@ -46,7 +50,7 @@
  * 
  * @param int32_t data - number to convert
  * @param uint8_t * ptr - pointer where we can save resulting string 
- * @param uint32_t base - number base from2 to 16
+ * @param uint32_t base - number base from 2 to 36
  * 
  * @return uint8_t - number of characters in the resulting sting, including end \0
  */
@@ -61,17 +65,154 @@
  * The character string to convert is passed in as a uint8_t * pointer (ptr).
  * The number of digits in your character set is passed in as a 
  *	uint8_t integer (digits).
- * You should be able to support bases 2 to 16.
+ * You should be able to support bases 2 to 36.
+ * Digits above 9 are letters, read in upper or lower case.
  * The converted 32-bit signed integer should be returned.
  * This function needs to handle signed data.
  * You may not use any string functions or libraries
  *
+ * Runs my_atoi_checked, and saturates the same way when the number
+ * does not fit. A string that is not a number is converted as before:
+ * characters that are no digit count as 0.
+ *
  * @param uint8_t * ptr - pointer to a number in a form of string to convert
  * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
- * @param uint32_t base - number base from 2 to 16
+ * @param uint32_t base - number base from 2 to 36
  * 
  * @return int32_t - converted number
  **/
  int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base);
+
+/* Results of my_atoi_checked */
+#define DATA_OK       (0)   /* the whole string is a number that fits */
+#define DATA_INVALID  (1)   /* a character is no digit of the base, or the string is empty */
+#define DATA_OVERFLOW (2)   /* the number does not fit in the result type */
+
+/**
+ * @brief Converts an ASCII string into an integer and checks it
+ *
+ * Takes the same string as my_atoi: an optional '-', the digits and the
+ * terminator, with (digits) counting all of them. Every character is
+ * checked in the same pass that converts it. Base 10 converts 8 digits
+ * per step with 64 bit multiply-adds (SWAR), and 16 per step with SSSE3
+ * on the host; base 16 converts 8 hex digits per step. Letters are
+ * accepted in upper and lower case.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ * @param int32_t * result - converted number; INT32_MAX or INT32_MIN on
+ *                           overflow, 0 for an invalid string
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
+ **/
+ int8_t my_atoi_checked(uint8_t * ptr, uint8_t digits, uint32_t base, int32_t * result);
+
+/**
+ * @brief Convert a signed 64 bit number into an ASCII string
+ *
+ * Same string as my_itoa. The Cortex-M4 divides 64 bit numbers in
+ * software only, so bases that are no power of two cut the value into
+ * chunks that fit 32 bits with at most two 64 bit divisions, and write
+ * the chunks with 32 bit divisions. Powers of two use shifts and masks.
+ *
+ * @param int64_t data - number to convert
+ * @param uint8_t * ptr - pointer where we can save resulting string, 66 bytes are enough for base 2
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint8_t - number of characters in the resulting sting, including end \0
+ */
+ uint8_t my_itoa64(int64_t data, uint8_t * ptr, uint32_t base);
+
+/**
+ * @brief Convert an unsigned 64 bit number into an ASCII string
+ *
+ * @param uint64_t data - number to convert
+ * @param uint8_t * ptr - pointer where we can save resulting string, 65 bytes are enough for base 2
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint8_t - number of characters in the resulting sting, including end \0
+ */
+ uint8_t my_utoa64(uint64_t data, uint8_t * ptr, uint32_t base);
+
+/**
+ * @brief Writes an array of numbers as delimited text into one buffer
+ *
+ * Each value is written like my_itoa does, with no terminator, straight
+ * into (out), and (delimiter) goes before every value but the first of
+ * the array. A value is only written whole: when the next one does not
+ * fit, the call stops and (index) tells where to go on. Calling again
+ * with the same (index) and a fresh buffer continues the same text, so
+ * the buffers put one after the other hold exactly what one big buffer
+ * would. A buffer of 34 bytes always takes at least one value.
+ *
+ * @param const int32_t * values - numbers to convert
+ * @param size_t count - number of values
+ * @param size_t * index - first value to write, 0 to start; set to the
+ *                         first value not written, (count) when done
+ * @param uint32_t base - number base from 2 to 36
+ * @param uint8_t delimiter - character between two values
+ * @param uint8_t * out - where to write the text
+ * @param size_t out_length - size of (out) in bytes
+ *
+ * @return size_t - number of bytes written, 0 for an unsupported base
+ */
+ size_t my_itoa_batch(const int32_t * values, size_t count, size_t * index, uint32_t base,
+                      uint8_t delimiter, uint8_t * out, size_t out_length);
+
+/**
+ * @brief Converts an ASCII string into a signed 64 bit integer and checks it
+ *
+ * Same string and checks as my_atoi_checked, with the range of int64_t.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ * @param int64_t * result - converted number; INT64_MAX or INT64_MIN on
+ *                           overflow, 0 for an invalid string
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
+ **/
+ int8_t my_atoi64_checked(uint8_t * ptr, uint8_t digits, uint32_t base, int64_t * result);
+
+/**
+ * @brief Converts an ASCII string into an unsigned 64 bit integer and checks it
+ *
+ * Same as my_atoi64_checked, except that a '-' makes the string invalid.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0
+ * @param uint32_t base - number base from 2 to 36
+ * @param uint64_t * result - converted number; UINT64_MAX on overflow, 0
+ *                            for an invalid string
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
+ **/
+ int8_t my_atou64_checked(uint8_t * ptr, uint8_t digits, uint32_t base, uint64_t * result);
+
+/**
+ * @brief Converts an ASCII string into a signed 64 bit integer
+ *
+ * my_atoi for int64_t: saturates on overflow, and reads a string that is
+ * not a number with characters that are no digit counting as 0.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return int64_t - converted number
+ **/
+ int64_t my_atoi64(uint8_t * ptr, uint8_t digits, uint32_t base);
+
+/**
+ * @brief Converts an ASCII string into an unsigned 64 bit integer
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint64_t - converted number, saturated like my_atoi64
+ **/
+ uint64_t my_atou64(uint8_t * ptr, uint8_t digits, uint32_t base);
  
 #endif /* __DATA_H__ */
@@ -25,6 +25,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#define MEM_ERROR    (1)
+#define MEM_NO_ERROR (0)
+
 /**
  * @brief Sets a value of a data array 
  *
@@ -133,6 +136,137 @@ uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length);
  */
 uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length);
 
+/**
+ * @brief Copies (length) bytes from (src) to (dst) on several threads
+ *
+ * The range is cut into one part per thread, with the inner cuts on page
+ * boundaries of the destination. Worker threads are created on first use
+ * and kept, and worker k always gets part k, so the pages of a freshly
+ * reserved buffer are first touched - and placed - by the thread that
+ * will keep working on them. Parts are at least a page long, and a call
+ * made while another parallel call runs is done on the calling thread.
+ * The regions must not overlap. On the MSP432 this is my_memcopy.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint8_t threads - Number of threads including the caller,
+ *                          0 for one per online CPU
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_memcopy_parallel(uint8_t * src, uint8_t * dst, size_t length, uint8_t threads);
+
+/**
+ * @brief Copies (length) bytes and returns the CRC-32 of them
+ *
+ * Computes the checksum while the data passes through the registers, so
+ * a checked copy reads the source only once. This is the CRC-32 of zlib
+ * and Ethernet (ISO 3309, polynomial 0x04C11DB7), the one the MSP432
+ * CRC32 module computes. The MSP432 build uses that module, the host
+ * folds 64 bytes per step with PCLMULQDQ, and a table driven path runs
+ * everywhere else. All give the same result.
+ *
+ * Call with crc 0 for the first block and with the previous result for
+ * each following block. The regions must not overlap.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t crc - CRC of the data before, 0 to start
+ *
+ * @return - CRC-32 of all data so far
+ */
+uint32_t my_memcopy_crc32(uint8_t * src, uint8_t * dst, size_t length, uint32_t crc);
+
+/**
+ * @brief Copies (length) bytes and returns the CRC-32C of them
+ *
+ * Same as my_memcopy_crc32 for the Castagnoli polynomial 0x1EDC6F41.
+ * The host uses the SSE4.2 crc32 instruction, 8 bytes at a time. The
+ * MSP432 CRC32 module does not support this polynomial, so the MSP432
+ * build uses the table driven path, with the same results.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t crc - CRC of the data before, 0 to start
+ *
+ * @return - CRC-32C of all data so far
+ */
+uint32_t my_memcopy_crc32c(uint8_t * src, uint8_t * dst, size_t length, uint32_t crc);
+
+/**
+ * @brief Copies (length) bytes and returns the Adler-32 of them
+ *
+ * The host sums 32 bytes per step with SSSE3, the MSP432 build a word
+ * at a time. Call with adler 1 for the first block and with the previous
+ * result for each following block.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t adler - Checksum of the data before, 1 to start
+ *
+ * @return - Adler-32 of all data so far
+ */
+uint32_t my_memcopy_adler32(uint8_t * src, uint8_t * dst, size_t length, uint32_t adler);
+
+/**
+ * @brief Sets the size from which copies and fills run on several threads
+ *
+ * my_memcopy, my_memset and my_memzero hand blocks of at least this size
+ * to the parallel variants with one thread per online CPU. The default is
+ * MEMORY_PARALLEL_THRESHOLD (64 MB), which can be changed at build time
+ * with -DMEMORY_PARALLEL_THRESHOLD=<bytes>. On a single CPU host, and on
+ * the MSP432, it has no effect.
+ *
+ * @param size_t threshold - Size in bytes, 0 turns the automatic mode off
+ */
+void set_parallel_threshold(size_t threshold);
+
+/**
+ * @brief Returns the size from which copies and fills run on several threads
+ *
+ * @return - size in bytes, 0 if the automatic mode is off
+ */
+size_t get_parallel_threshold(void);
+
+
+/**
+ * @brief Descriptor of one region for my_memmove_sg
+ *
+ * Modeled on the channel control structures of the MSP432 uDMA
+ * controller: where to read, where to write and how much, plus
+ * a completion flag.
+ */
+typedef struct
+{
+  uint8_t * src;   /* first byte to read */
+  uint8_t * dst;   /* first byte to write */
+  size_t length;   /* number of bytes */
+  uint8_t done;    /* set to 1 once the region has been moved */
+} mem_desc_t;
+
+/**
+ * @brief Moves a list of regions described by {src, dst, length}
+ *
+ * This replaces one my_memmove call per region. The list is sorted
+ * by source address, and descriptors that continue each other in both
+ * source and destination are merged into one move. Every region is moved
+ * with my_memmove semantics, so a descriptor's own src and dst may
+ * overlap. Regions of different descriptors must not overlap each other.
+ *
+ * The done flag of each descriptor is set when its region has been
+ * moved.
+ *
+ * @param mem_desc_t * list - Array of descriptors, reordered by the call
+ * @param size_t count - Number of descriptors
+ *
+ * @return - total number of bytes moved
+ */
+size_t my_memmove_sg(mem_desc_t * list, size_t count);
+
 
 /**
  * @brief Set all (length) bytes at address (src) to a given (value)
@@ -143,6 +277,10 @@ uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length);
  *
  * You should NOT reuse the set_all() function
  *
+ * Short fills use wide stores. On the host, fills of at least
+ * get_memset_nt_threshold() bytes use non-temporal streaming stores
+ * followed by a store fence, so they do not evict the cache.
+ *
  * @param uint8_t * src - Pointer to source
  * @param size_t length - Number of bytes to set to a value
  * @param uint8_t value - Value to be set
@@ -151,6 +289,25 @@ uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length);
  */
 uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value);
 
+/**
+ * @brief Sets the size from which my_memset uses streaming stores
+ *
+ * The default is MEMSET_NT_THRESHOLD (4 MB), which can be changed
+ * at build time with -DMEMSET_NT_THRESHOLD=<bytes>. Streaming only
+ * pays off for blocks much bigger than the last level cache.
+ * It has no effect on the MSP432 build. Applies to my_memzero too.
+ *
+ * @param size_t threshold - Size in bytes, 0 turns streaming off
+ */
+void set_memset_nt_threshold(size_t threshold);
+
+/**
+ * @brief Returns the size from which my_memset uses streaming stores
+ *
+ * @return - size in bytes, 0 if streaming is off
+ */
+size_t get_memset_nt_threshold(void);
+
 
 /**
  * @brief Set all (length) bytes at address (src) to a zero
@@ -167,6 +324,34 @@ uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value);
  */
 uint8_t * my_memzero(uint8_t * src, size_t length);
 
+/**
+ * @brief Sets (length) bytes at (src) to (value) on several threads
+ *
+ * Split the same way as my_memcopy_parallel. Streaming stores are used
+ * when the whole block reaches get_memset_nt_threshold().
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to a value
+ * @param uint8_t value - Value to be set
+ * @param uint8_t threads - Number of threads including the caller,
+ *                          0 for one per online CPU
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memset_parallel(uint8_t * src, size_t length, uint8_t value, uint8_t threads);
+
+/**
+ * @brief Sets (length) bytes at (src) to zero on several threads
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to 0
+ * @param uint8_t threads - Number of threads including the caller,
+ *                          0 for one per online CPU
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memzero_parallel(uint8_t * src, size_t length, uint8_t threads);
+
 
 /**
  * @brief Reverse the order of all of the bytes
@@ -174,6 +359,9 @@ uint8_t * my_memzero(uint8_t * src, size_t length);
  * This should take a pointer to a memory location 
  * and a length in bytes and reverse the order of all of the bytes.
  *
+ * The reversal is done in place and uses no additional memory,
+ * so it works for buffers of any size.
+ *
  * @param uint8_t * src - Pointer to source
  * @param size_t length - Number of bytes to reverse
  *
@@ -181,6 +369,118 @@ uint8_t * my_memzero(uint8_t * src, size_t length);
  */
 uint8_t * my_reverse(uint8_t * src, size_t length);
 
+/**
+ * @brief Rotates (length) bytes in place so byte (shift) comes first
+ *
+ * Turns a circular buffer into linear order: with (shift) the index of
+ * the oldest byte, the oldest byte ends up at src[0]. The rotation uses
+ * a small stack buffer at most, never a copy of the data. When one side
+ * of the rotation is short it is buffered and the rest moved once with
+ * my_memmove. Otherwise the data is reversed three times with the vector
+ * my_reverse kernels, or, without them (MSP432, MEMORY_NO_SIMD), rotated
+ * with block swaps, which pass over the data only once.
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to rotate
+ * @param size_t shift - Bytes to rotate to the left, taken modulo length
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_rotate(uint8_t * src, size_t length, size_t shift);
+
+
+/**
+ * @brief Swaps the bytes of (count) 16 bit values
+ *
+ * Converts an array between little and big endian, in place when (dst)
+ * equals (src), otherwise into (dst); other overlaps are not allowed.
+ * No alignment is needed. The host uses pshufb/vpshufb, the MSP432 build
+ * REV16 on two values at a time.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 16 bit values
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_bswap16(uint8_t * src, uint8_t * dst, size_t count);
+
+/**
+ * @brief Swaps the bytes of (count) 32 bit values
+ *
+ * Same as my_bswap16 for 32 bit values, REV on the MSP432.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 32 bit values
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_bswap32(uint8_t * src, uint8_t * dst, size_t count);
+
+/**
+ * @brief Swaps the bytes of (count) 64 bit values
+ *
+ * Same as my_bswap16 for 64 bit values, two REV on the MSP432.
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 64 bit values
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_bswap64(uint8_t * src, uint8_t * dst, size_t count);
+
+/**
+ * @brief Finds the first byte where two buffers differ
+ *
+ * On the host 16 or 32 bytes are compared per step, the MSP432 build
+ * compares a word at a time and finds the byte in the word with CLZ.
+ *
+ * @param uint8_t * src1 - First buffer
+ * @param uint8_t * src2 - Second buffer
+ * @param size_t length - Number of bytes to compare
+ *
+ * @return - index of the first differing byte, or (length) if equal
+ */
+size_t my_mismatch(uint8_t * src1, uint8_t * src2, size_t length);
+
+/**
+ * @brief Compares two buffers byte by byte, as unsigned values
+ *
+ * Built on my_mismatch.
+ *
+ * @param uint8_t * src1 - First buffer
+ * @param uint8_t * src2 - Second buffer
+ * @param size_t length - Number of bytes to compare
+ *
+ * @return - 0 if the buffers are equal, otherwise a negative or positive
+ *           value: the difference of the first differing bytes
+ */
+int32_t my_memcmp(uint8_t * src1, uint8_t * src2, size_t length);
+
+/**
+ * @brief Finds the first byte with a given (value)
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to search
+ * @param uint8_t value - Value to look for
+ *
+ * @return - a pointer to the first such byte, or NULL if there is none
+ */
+uint8_t * my_memchr(uint8_t * src, size_t length, uint8_t value);
+
+/**
+ * @brief Finds the last byte with a given (value)
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to search
+ * @param uint8_t value - Value to look for
+ *
+ * @return - a pointer to the last such byte, or NULL if there is none
+ */
+uint8_t * my_memrchr(uint8_t * src, size_t length, uint8_t value);
+
 
 /**
  * @brief Allocate in dynamic memory
@@ -205,4 +505,463 @@ int32_t * reserve_words(size_t length);
  */
 void free_words(int32_t * src);
 
+/**
+ * @brief Grows a block from reserve_words to (new_length) words
+ *
+ * The block is grown in place when its backend allows it: the most
+ * recent arena block, a pool block that already has the room, or a
+ * malloc block that realloc can extend. Otherwise this is reserve_words,
+ * my_memcopy of the kept words and free_words. Blocks are never shrunk.
+ *
+ * @param int32_t * src - Block to grow, NULL to reserve a new one
+ * @param size_t old_length - Number of words to keep, at most the size
+ *                            of the block
+ * @param size_t new_length - Number of words needed
+ *
+ * @return - a pointer to the grown block, which may have moved, or a
+ *           Null Pointer if there is no memory; (src) then stays valid
+ */
+int32_t * resize_words(int32_t * src, size_t old_length, size_t new_length);
+
+/**
+ * @brief Reserves (length) words starting at a multiple of (alignment)
+ *
+ * Use a cache line (64) or the vector width (16, 32, 64) so the SIMD
+ * kernels start on aligned addresses. The block is taken from
+ * reserve_words, a few words bigger, and has to be freed with
+ * free_words_aligned.
+ *
+ * @param size_t length - Number of words to reserve
+ * @param size_t alignment - Alignment in bytes, a power of two
+ *
+ * @return - a pointer to the aligned memory, or a Null Pointer if not
+ *           successful or the alignment is not a power of two
+ */
+int32_t * reserve_words_aligned(size_t length, size_t alignment);
+
+/**
+ * @brief Frees a block from reserve_words_aligned
+ *
+ * @param int32_t * src - Block to free, may be NULL
+ */
+void free_words_aligned(int32_t * src);
+
+/* Flags of reserve_words_large */
+#define MEM_LARGE_HUGE_PAGES (0x01)  /* MAP_HUGETLB, needs reserved huge pages */
+#define MEM_LARGE_THP        (0x02)  /* 2 MB aligned, MADV_HUGEPAGE hint */
+#define MEM_LARGE_POPULATE   (0x04)  /* fault all pages in now */
+
+/**
+ * @brief Reserves a large block straight from the operating system
+ *
+ * On the host the block is mapped with mmap, which keeps big datasets
+ * out of the heap and allows huge pages, so they need fewer TLB entries.
+ * MEM_LARGE_HUGE_PAGES asks for explicit huge pages and falls back to
+ * MEM_LARGE_THP, or to normal pages, when none are reserved. MEM_LARGE_THP
+ * aligns the mapping to 2 MB and hints transparent huge pages.
+ * MEM_LARGE_POPULATE faults every page in before returning, so the first
+ * pass over the data does not pay for it.
+ *
+ * The data is aligned to 64 bytes. It must be freed with free_words_large.
+ * On the MSP432 this is reserve_words_aligned(length, 64).
+ *
+ * @param size_t length - Number of words to reserve
+ * @param uint8_t flags - MEM_LARGE_* flags, or 0
+ *
+ * @return - a pointer to memory if successful,
+ *            or a Null Pointer if not successful
+ */
+int32_t * reserve_words_large(size_t length, uint8_t flags);
+
+/**
+ * @brief Frees a block from reserve_words_large
+ *
+ * @param int32_t * src - Block to free, may be NULL
+ */
+void free_words_large(int32_t * src);
+
+/**
+ * @brief Grows a block from reserve_words_large to (new_length) words
+ *
+ * On the host the mapping is grown with mremap: the kernel extends it
+ * in place, or moves its pages to a bigger free range, so growing even a
+ * 1 GB block copies no data. Only when mremap is refused are the kept
+ * words copied to a new mapping. On the MSP432 the block is always
+ * copied to a new one.
+ *
+ * @param int32_t * src - Block to grow, NULL to map a new one
+ * @param size_t old_length - Number of words to keep
+ * @param size_t new_length - Number of words needed
+ *
+ * @return - a pointer to the grown block, which may have moved, or a
+ *           Null Pointer if there is no memory; (src) then stays valid
+ */
+int32_t * resize_words_large(int32_t * src, size_t old_length, size_t new_length);
+
+
+/************************** allocation statistics *********************/
+/*
+ * Building with -DMEMORY_INSTRUMENT (make INSTRUMENT=YES) makes
+ * reserve_words/free_words count calls and bytes and remember every
+ * outstanding block. The blocks still outstanding are printed at exit.
+ * Without the define the hooks compile to nothing, and memory_get_stats()
+ * reports MEM_ERROR.
+ *
+ * Only reserve_words/free_words are counted, direct pool_reserve()
+ * calls are not seen. Blocks given back in bulk by arena_rewind(),
+ * arena_reset() or arena_release() are no longer outstanding, but
+ * are not counted as free_words calls.
+ */
+#define MEM_STATS_BUCKETS (16)
+
+typedef struct
+{
+  size_t reserve_calls;     /* calls to reserve_words */
+  size_t free_calls;        /* calls to free_words with a non-NULL block */
+  size_t failed_reserves;   /* reserve_words calls that returned NULL */
+  size_t blocks_in_flight;  /* blocks reserved and not freed */
+  size_t bytes_in_flight;   /* bytes in those blocks */
+  size_t peak_bytes;        /* highest value of bytes_in_flight */
+  size_t untracked;         /* blocks the outstanding table had no room for */
+  /* reserves by size: bucket 0 up to 16 bytes, bucket i up to 16 << i
+     bytes, the last bucket everything bigger */
+  size_t size_histogram[MEM_STATS_BUCKETS];
+} mem_stats_t;
+
+/**
+ * @brief Copies the allocation counters of an instrumented build
+ *
+ * @param mem_stats_t * stats - Where to copy the counters
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if the build is not instrumented
+ */
+int8_t memory_get_stats(mem_stats_t * stats);
+
+/**
+ * @brief Resets the call counters and the histogram, and sets the peak
+ * to the bytes in flight now
+ */
+void memory_reset_stats(void);
+
+/**
+ * @brief Prints every block reserved and not freed yet
+ *
+ * @return - number of outstanding blocks, 0 if not instrumented
+ */
+size_t memory_dump_outstanding(void);
+
+
+/************************** pool allocator *********************/
+/*
+ * A pool hands out blocks of one fixed size. Free blocks are kept in a
+ * list that is linked through the blocks themselves, so reserving and
+ * freeing a block take constant time and the pool never fragments.
+ *
+ * A pool can be used directly with pool_reserve()/pool_free(). It can also
+ * be attached, which makes reserve_words take blocks of up to block_words
+ * from the smallest attached pool that has one free. Requests that fit no
+ * pool go on to the arena or to malloc. free_words recognises pool blocks by
+ * their address. Attaching pools for recurring sizes such as
+ * DATA_SET_SIZE_W and MEM_SET_SIZE_W takes them off the general heap.
+ *
+ * Pools are not thread safe.
+ */
+typedef struct mem_pool
+{
+  int32_t * storage;       /* first block */
+  size_t block_words;      /* block size in words, rounded up for the link */
+  size_t block_count;      /* number of blocks */
+  void * free_list;        /* freed blocks, linked through their first word */
+  size_t untouched;        /* blocks before this index have been handed out */
+  size_t in_use;           /* blocks currently handed out */
+  size_t peak;             /* highest value of in_use */
+  struct mem_pool * next;  /* next attached pool */
+  uint8_t attached;        /* pool is attached to reserve_words */
+  uint8_t owned;           /* storage was reserved by pool_init */
+} mem_pool_t;
+
+/**
+ * @brief Sets up a pool of fixed-size blocks
+ *
+ * (storage) must be aligned for a pointer and hold block_words *
+ * block_count words, after block_words is rounded up to hold a
+ * pointer. If it is NULL the storage is taken from reserve_words once.
+ *
+ * @param mem_pool_t * pool - Pool to set up
+ * @param int32_t * storage - Memory for the blocks, or NULL
+ * @param size_t block_words - Size of one block in words
+ * @param size_t block_count - Number of blocks
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory for the pool
+ */
+int8_t pool_init(mem_pool_t * pool, int32_t * storage, size_t block_words, size_t block_count);
+
+/**
+ * @brief Takes one block from a pool
+ *
+ * @param mem_pool_t * pool - Pool to take the block from
+ *
+ * @return - a pointer to the block, or a Null Pointer if the pool is empty
+ */
+int32_t * pool_reserve(mem_pool_t * pool);
+
+/**
+ * @brief Gives a block back to its pool
+ *
+ * Pointers that are not inside the pool are ignored.
+ *
+ * @param mem_pool_t * pool - Pool the block was taken from
+ * @param int32_t * block - Block to give back
+ */
+void pool_free(mem_pool_t * pool, int32_t * block);
+
+/**
+ * @brief Routes reserve_words/free_words of fitting sizes to a pool
+ *
+ * @param mem_pool_t * pool - Pool set up by pool_init()
+ */
+void pool_attach(mem_pool_t * pool);
+
+/**
+ * @brief Stops routing reserve_words/free_words to a pool
+ *
+ * Blocks still in use must then be freed with pool_free().
+ *
+ * @param mem_pool_t * pool - Pool attached by pool_attach()
+ */
+void pool_detach(mem_pool_t * pool);
+
+/**
+ * @brief Detaches a pool and frees its storage if pool_init() reserved it
+ *
+ * @param mem_pool_t * pool - Pool to destroy
+ */
+void pool_destroy(mem_pool_t * pool);
+
+/**
+ * @brief Returns the number of blocks of a pool in use
+ *
+ * @param const mem_pool_t * pool - Pool to query
+ *
+ * @return - blocks in use
+ */
+size_t pool_in_use(const mem_pool_t * pool);
+
+/**
+ * @brief Returns the highest number of blocks of a pool in use at once
+ *
+ * @param const mem_pool_t * pool - Pool to query
+ *
+ * @return - peak of blocks in use
+ */
+size_t pool_peak(const mem_pool_t * pool);
+
+
+/************************** arena allocator *********************/
+/*
+ * With an arena set up, reserve_words hands out blocks from one region
+ * by moving a pointer, and free_words only gives back the most recent
+ * block. Everything else is freed in bulk by arena_rewind() or
+ * arena_reset(), so a batch of work does no malloc traffic at all.
+ *
+ * The arena is set up at run time with arena_init(), or at build time
+ * with -DMEMORY_ARENA_WORDS=<n> (make ARENA_WORDS=<n>), which places it
+ * in a static array and keeps malloc out of reserve_words completely.
+ *
+ * The arena is not thread safe.
+ */
+
+/**
+ * @brief Switches reserve_words/free_words to an arena
+ *
+ * The region is taken from malloc once if (region) is NULL. An arena
+ * that is already set up is released first.
+ *
+ * @param int32_t * region - Memory for the arena, or NULL
+ * @param size_t length - Size of the region in words
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if no region could be set up
+ */
+int8_t arena_init(int32_t * region, size_t length);
+
+/**
+ * @brief Returns the current top of the arena
+ *
+ * @return - number of words in use, to pass to arena_rewind()
+ */
+size_t arena_mark(void);
+
+/**
+ * @brief Frees every arena block reserved after a mark
+ *
+ * @param size_t mark - Value returned by arena_mark()
+ */
+void arena_rewind(size_t mark);
+
+/**
+ * @brief Frees all arena blocks at once
+ */
+void arena_reset(void);
+
+/**
+ * @brief Returns the number of arena words in use
+ *
+ * @return - words in use, including alignment padding
+ */
+size_t arena_used(void);
+
+/**
+ * @brief Turns the arena set up by arena_init() off
+ *
+ * Gives the region back to malloc if arena_init() took it from there.
+ * reserve_words goes back to malloc, or to the build-time arena
+ * if there is one.
+ */
+void arena_release(void);
+
+
+/************************** buffer slices *********************/
+/*
+ * A slice is a view of (length) bytes at (data) inside a block from
+ * reserve_words. The block starts with a reference count, and each slice
+ * holds one reference. Taking a slice of a slice only adds a reference and
+ * moves the pointer, no data is copied, and slice.data/slice.length can go
+ * straight to functions such as find_mean() or sort_merge(). The block is
+ * freed when the last slice of it is released.
+ *
+ * A slice is a small value and can be passed around by copy, but every
+ * reference has to be taken with slice_reserve, slice_sub or slice_retain
+ * and given back with slice_release exactly once. Reference counting is
+ * atomic, so slices of one block can be released on different threads;
+ * writes to the data need the caller's own synchronisation.
+ */
+typedef struct
+{
+  struct mem_slice_block * block;   /* backing block, NULL for an empty slice */
+  uint8_t * data;                   /* first byte of the view */
+  size_t length;                    /* number of bytes of the view */
+} mem_slice_t;
+
+/**
+ * @brief Reserves a new backing block and returns a slice of all of it
+ *
+ * @param size_t length - Number of data bytes
+ *
+ * @return - the slice, an empty slice (data NULL) if there is no memory
+ */
+mem_slice_t slice_reserve(size_t length);
+
+/**
+ * @brief Returns a slice of (length) bytes at (offset) inside (parent)
+ *
+ * The new slice holds its own reference to the block, so the parent can
+ * be released before it.
+ *
+ * @param mem_slice_t parent - Slice to take the view from
+ * @param size_t offset - Start of the view inside the parent
+ * @param size_t length - Number of bytes of the view
+ *
+ * @return - the slice, an empty slice if the range is not inside the parent
+ */
+mem_slice_t slice_sub(mem_slice_t parent, size_t offset, size_t length);
+
+/**
+ * @brief Takes one more reference for a copy of (slice)
+ *
+ * @param mem_slice_t slice - Slice to share
+ *
+ * @return - the same view, holding its own reference
+ */
+mem_slice_t slice_retain(mem_slice_t slice);
+
+/**
+ * @brief Gives a reference back and empties the slice
+ *
+ * Frees the backing block with free_words when this was the last
+ * reference. Empty slices are ignored.
+ *
+ * @param mem_slice_t * slice - Slice to release
+ */
+void slice_release(mem_slice_t * slice);
+
+/**
+ * @brief Returns the number of slices sharing the block of (slice)
+ *
+ * @param mem_slice_t slice - Slice to query
+ *
+ * @return - references to the backing block, 0 for an empty slice
+ */
+size_t slice_refs(mem_slice_t slice);
+
+
+/*************************** word buffers ***************************/
+/*
+ * A word buffer is an array of words that grows as words are appended,
+ * for samples that arrive a few at a time. The capacity doubles on every
+ * growth, so appending n words costs O(n) in total. Small buffers live in
+ * reserve_words blocks and are grown with resize_words. Once the capacity
+ * reaches MEMORY_WORDBUF_LARGE_WORDS the words are copied once to a
+ * reserve_words_large block, which is grown with mremap from then on.
+ *
+ * buf.data/buf.length can go straight to functions such as find_mean().
+ * The data may move on every growth, pointers into it do not stay valid.
+ */
+#ifndef MEMORY_WORDBUF_LARGE_WORDS
+  #define MEMORY_WORDBUF_LARGE_WORDS (256UL * 1024UL)   /* 1 MB */
+#endif
+
+typedef struct
+{
+  int32_t * data;     /* the words, NULL before the first growth */
+  size_t length;      /* words in use */
+  size_t capacity;    /* words reserved */
+  uint8_t large;      /* data is a reserve_words_large block */
+} mem_wordbuf_t;
+
+/**
+ * @brief Sets up an empty word buffer, nothing is reserved yet
+ *
+ * @param mem_wordbuf_t * buf - Buffer to set up
+ */
+void wordbuf_init(mem_wordbuf_t * buf);
+
+/**
+ * @brief Makes room for at least (capacity) words
+ *
+ * @param mem_wordbuf_t * buf - Buffer to grow
+ * @param size_t capacity - Number of words needed
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory, in which
+ *           case the buffer is left as it was
+ */
+int8_t wordbuf_reserve(mem_wordbuf_t * buf, size_t capacity);
+
+/**
+ * @brief Sets the number of words in use, growing the buffer if needed
+ *
+ * @param mem_wordbuf_t * buf - Buffer to resize
+ * @param size_t length - New number of words, added words are not set
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory
+ */
+int8_t wordbuf_resize(mem_wordbuf_t * buf, size_t length);
+
+/**
+ * @brief Adds (count) words at the end of the buffer
+ *
+ * @param mem_wordbuf_t * buf - Buffer to add to
+ * @param const int32_t * words - Words to add
+ * @param size_t count - Number of words
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory
+ */
+int8_t wordbuf_append(mem_wordbuf_t * buf, const int32_t * words, size_t count);
+
+/**
+ * @brief Frees the words of a buffer and leaves it empty
+ *
+ * @param mem_wordbuf_t * buf - Buffer to free
+ */
+void wordbuf_free(mem_wordbuf_t * buf);
+
 #endif /* __MEMORY_H__ */
@@ -0,0 +1,160 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file ring_buffer.h
+ * @brief Lock-free byte ring buffer for one producer and one consumer
+ *
+ * The producer (a thread, or an interrupt handler on the MSP432) only
+ * moves the head, the consumer only moves the tail, so no lock is needed.
+ * The capacity is a power of two, indexes run freely and are masked on
+ * access. Head and tail sit on cache lines of their own together with the
+ * other side's index as last seen, so the two sides do not share a line.
+ *
+ * Bulk writes and reads move data with at most two my_memcopy calls, one
+ * up to the end of the storage and one from its start. The peek/commit
+ * calls hand out the contiguous region directly for zero-copy use.
+ *
+ * @author Oksana Vynokurova
+ * @date 11/2024
+ *
+ */
+#ifndef __RING_BUFFER_H__
+#define __RING_BUFFER_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/* The MSP432 has no data cache, word alignment keeps the struct small */
+#if defined (MSP432)
+  #define RING_CACHE_LINE (4)
+#else
+  #define RING_CACHE_LINE (64)
+#endif
+
+typedef struct
+{
+  /* read only after ring_init */
+  uint8_t * storage;
+  size_t mask;               /* capacity - 1 */
+  uint8_t owned;             /* storage came from reserve_words */
+
+  /* producer side */
+  size_t head __attribute__((aligned(RING_CACHE_LINE)));
+  size_t tail_seen;          /* tail as last read by the producer */
+
+  /* consumer side */
+  size_t tail __attribute__((aligned(RING_CACHE_LINE)));
+  size_t head_seen;          /* head as last read by the consumer */
+} __attribute__((aligned(RING_CACHE_LINE))) ring_buffer_t;
+
+/**
+ * @brief Sets up an empty ring buffer
+ *
+ * @param ring_buffer_t * ring - Ring buffer to set up
+ * @param uint8_t * storage - Memory for the data, or NULL to take it
+ *                            from reserve_words
+ * @param size_t capacity - Size of the storage in bytes, a power of two
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if the capacity is not a power of
+ *           two or there is no memory
+ */
+int8_t ring_init(ring_buffer_t * ring, uint8_t * storage, size_t capacity);
+
+/**
+ * @brief Gives back the storage taken by ring_init
+ *
+ * @param ring_buffer_t * ring - Ring buffer, not in use by either side
+ */
+void ring_destroy(ring_buffer_t * ring);
+
+/**
+ * @brief Number of bytes waiting to be read
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ *
+ * @return - bytes that can be read
+ */
+size_t ring_used(ring_buffer_t * ring);
+
+/**
+ * @brief Number of bytes that can be written
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ *
+ * @return - bytes that can be written
+ */
+size_t ring_free(ring_buffer_t * ring);
+
+/**
+ * @brief Writes up to (length) bytes, producer side
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param uint8_t * src - Data to write
+ * @param size_t length - Number of bytes to write
+ *
+ * @return - number of bytes written, less than length if the ring is full
+ */
+size_t ring_write(ring_buffer_t * ring, uint8_t * src, size_t length);
+
+/**
+ * @brief Reads up to (length) bytes, consumer side
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param uint8_t * dst - Where to put the data
+ * @param size_t length - Number of bytes to read
+ *
+ * @return - number of bytes read, less than length if the ring runs empty
+ */
+size_t ring_read(ring_buffer_t * ring, uint8_t * dst, size_t length);
+
+/**
+ * @brief Returns the free region that can be written without wrapping
+ *
+ * The producer fills the region in place and publishes it with
+ * ring_write_commit. A second call may return more after the first
+ * region is committed, when the free space wraps around.
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param size_t * length - Set to the size of the region, 0 if full
+ *
+ * @return - start of the region
+ */
+uint8_t * ring_write_peek(ring_buffer_t * ring, size_t * length);
+
+/**
+ * @brief Publishes (length) bytes written into a ring_write_peek region
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param size_t length - Bytes written, at most the peeked length
+ */
+void ring_write_commit(ring_buffer_t * ring, size_t length);
+
+/**
+ * @brief Returns the data that can be read without wrapping
+ *
+ * The consumer uses the data in place and frees it with ring_read_commit.
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param size_t * length - Set to the size of the region, 0 if empty
+ *
+ * @return - start of the region
+ */
+uint8_t * ring_read_peek(ring_buffer_t * ring, size_t * length);
+
+/**
+ * @brief Frees (length) bytes of a ring_read_peek region
+ *
+ * @param ring_buffer_t * ring - Ring buffer
+ * @param size_t length - Bytes consumed, at most the peeked length
+ */
+void ring_read_commit(ring_buffer_t * ring, size_t length);
+
+#endif /* __RING_BUFFER_H__ */
@@ -17,6 +17,7 @@ ifeq ($(PLATFORM), MSP432)
 		   ./src/data.c \
 		   ./src/course1.c \
 		   ./src/stats.c \
+		   ./src/ring_buffer.c \
 		  ./src/startup_msp432p401r_gcc.c \
 		  ./src/system_msp432p401r.c \
 		  ./src/interrupts_msp432p401r_gcc.c
@@ -37,7 +38,9 @@ else
 	 	   ./src/memory.c \
 		   ./src/data.c \
 		   ./src/course1.c \
-		   ./src/stats.c 
+		   ./src/stats.c \
+		   ./src/ring_buffer.c \
+		   ./src/async_copy.c
 		 	   
 	# Include paths for HOST platform
 	INCLUDES = -I./include/common
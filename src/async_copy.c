@@ -0,0 +1,310 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file async_copy.c
+ * @brief Copies and fills that run in the background on worker threads
+ *
+ * Requests wait in a FIFO queue. Each worker takes the next chunk of the
+ * request at the head of the queue, so several workers share one big
+ * request, and a request leaves the queue once all its chunks are handed
+ * out. The worker that finishes the last chunk runs the callback and then
+ * marks the request done.
+ *
+ * @author Oksana Vynokurova
+ * @date 11/2024
+ *
+ */
+/* pthreads under -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include "async_copy.h"
+#include "memory.h"
+#include "platform.h"
+
+typedef enum
+{
+  ASYNC_OP_COPY,
+  ASYNC_OP_FILL
+} async_op_t;
+
+struct async_request
+{
+  async_op_t op;
+  uint8_t * src;
+  uint8_t * dst;
+  size_t length;
+  uint8_t value;
+  size_t chunks;              /* number of chunks of the request */
+  size_t next_chunk;          /* first chunk not handed to a worker yet */
+  size_t chunks_done;         /* chunks moved completely */
+  async_callback_t callback;
+  void * context;
+  uint8_t done;
+  struct async_request * next;
+};
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t work;        /* signalled when a request is queued */
+  pthread_cond_t finished;    /* signalled when a request is done */
+  pthread_t threads[ASYNC_MAX_THREADS];
+  uint8_t thread_count;
+  uint8_t running;
+  uint8_t stopping;
+  size_t chunk_bytes;
+  struct async_request * head;
+  struct async_request * tail;
+} async_engine_t;
+
+static async_engine_t engine =
+{
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .work = PTHREAD_COND_INITIALIZER,
+  .finished = PTHREAD_COND_INITIALIZER,
+};
+
+/* Moves one chunk of a request, without holding the engine lock */
+static void async_move_chunk(struct async_request * req, size_t chunk, size_t chunk_bytes)
+{
+  size_t offset = chunk * chunk_bytes;
+  size_t length = req->length - offset;
+
+  if (length > chunk_bytes)
+  {
+    length = chunk_bytes;
+  }
+
+  if (req->op == ASYNC_OP_COPY)
+  {
+    my_memcopy(req->src + offset, req->dst + offset, length);
+  }
+  else
+  {
+    my_memset(req->dst + offset, length, req->value);
+  }
+}
+
+/* Runs the callback, then lets waiters see the request as done */
+static void async_complete(struct async_request * req)
+{
+  if (req->callback)
+  {
+    req->callback(req, req->context);
+  }
+  pthread_mutex_lock(&engine.lock);
+  req->done = 1;
+  pthread_cond_broadcast(&engine.finished);
+  pthread_mutex_unlock(&engine.lock);
+}
+
+static void * async_worker(void * arg)
+{
+  struct async_request * req;
+  size_t chunk;
+  size_t chunk_bytes;
+  uint8_t last;
+
+  (void) arg;
+  pthread_mutex_lock(&engine.lock);
+  while (1)
+  {
+    while ((engine.head == NULL) && !engine.stopping)
+    {
+      pthread_cond_wait(&engine.work, &engine.lock);
+    }
+    if (engine.head == NULL)
+    {
+      /* stopping and the queue is drained */
+      break;
+    }
+
+    req = engine.head;
+    chunk = req->next_chunk++;
+    if (req->next_chunk == req->chunks)
+    {
+      engine.head = req->next;
+      if (engine.head == NULL)
+      {
+        engine.tail = NULL;
+      }
+    }
+    chunk_bytes = engine.chunk_bytes;
+    pthread_mutex_unlock(&engine.lock);
+
+    async_move_chunk(req, chunk, chunk_bytes);
+
+    pthread_mutex_lock(&engine.lock);
+    last = (++req->chunks_done == req->chunks);
+    if (last)
+    {
+      pthread_mutex_unlock(&engine.lock);
+      async_complete(req);
+      pthread_mutex_lock(&engine.lock);
+    }
+  }
+  pthread_mutex_unlock(&engine.lock);
+  return NULL;
+}
+
+static async_handle_t async_submit(async_op_t op, uint8_t * src, uint8_t * dst,
+                                   size_t length, uint8_t value,
+                                   async_callback_t callback, void * context)
+{
+  struct async_request * req;
+
+  req = (struct async_request *) reserve_words((sizeof(struct async_request) + sizeof(int32_t) - 1) / sizeof(int32_t));
+  if (!req)
+  {
+    return NULL;
+  }
+
+  req->op = op;
+  req->src = src;
+  req->dst = dst;
+  req->length = length;
+  req->value = value;
+  req->next_chunk = 0;
+  req->chunks_done = 0;
+  req->callback = callback;
+  req->context = context;
+  req->done = 0;
+  req->next = NULL;
+
+  pthread_mutex_lock(&engine.lock);
+  if (!engine.running || engine.stopping || (length == 0))
+  {
+    /* no workers - behave like a plain my_memcopy/my_memset */
+    pthread_mutex_unlock(&engine.lock);
+    req->chunks = 1;
+    async_move_chunk(req, 0, length);
+    req->chunks_done = 1;
+    async_complete(req);
+    return req;
+  }
+
+  req->chunks = (length + engine.chunk_bytes - 1) / engine.chunk_bytes;
+  if (engine.tail)
+  {
+    engine.tail->next = req;
+  }
+  else
+  {
+    engine.head = req;
+  }
+  engine.tail = req;
+  pthread_cond_broadcast(&engine.work);
+  pthread_mutex_unlock(&engine.lock);
+
+  return req;
+}
+
+int8_t async_copy_init(uint8_t threads, size_t chunk_bytes)
+{
+  uint8_t i;
+  int8_t ret;
+
+  if ((threads == 0) || (threads > ASYNC_MAX_THREADS))
+  {
+    return MEM_ERROR;
+  }
+
+  pthread_mutex_lock(&engine.lock);
+  if (engine.running)
+  {
+    pthread_mutex_unlock(&engine.lock);
+    return MEM_ERROR;
+  }
+  engine.chunk_bytes = chunk_bytes ? chunk_bytes : ASYNC_DEFAULT_CHUNK_B;
+  engine.stopping = 0;
+  engine.thread_count = 0;
+  for (i = 0; i < threads; i++)
+  {
+    if (pthread_create(&engine.threads[i], NULL, async_worker, NULL) != 0)
+    {
+      break;
+    }
+    engine.thread_count++;
+  }
+  engine.running = (engine.thread_count > 0);
+  ret = engine.running ? MEM_NO_ERROR : MEM_ERROR;
+  pthread_mutex_unlock(&engine.lock);
+
+  return ret;
+}
+
+void async_copy_shutdown(void)
+{
+  uint8_t i;
+
+  pthread_mutex_lock(&engine.lock);
+  if (!engine.running)
+  {
+    pthread_mutex_unlock(&engine.lock);
+    return;
+  }
+  engine.stopping = 1;
+  pthread_cond_broadcast(&engine.work);
+  pthread_mutex_unlock(&engine.lock);
+
+  for (i = 0; i < engine.thread_count; i++)
+  {
+    pthread_join(engine.threads[i], NULL);
+  }
+
+  pthread_mutex_lock(&engine.lock);
+  engine.running = 0;
+  engine.thread_count = 0;
+  pthread_mutex_unlock(&engine.lock);
+}
+
+async_handle_t async_copy_submit(uint8_t * src, uint8_t * dst, size_t length,
+                                 async_callback_t callback, void * context)
+{
+  return async_submit(ASYNC_OP_COPY, src, dst, length, 0, callback, context);
+}
+
+async_handle_t async_fill_submit(uint8_t * dst, size_t length, uint8_t value,
+                                 async_callback_t callback, void * context)
+{
+  return async_submit(ASYNC_OP_FILL, NULL, dst, length, value, callback, context);
+}
+
+uint8_t async_copy_poll(async_handle_t handle)
+{
+  uint8_t done;
+
+  pthread_mutex_lock(&engine.lock);
+  done = handle->done;
+  pthread_mutex_unlock(&engine.lock);
+  return done;
+}
+
+void async_copy_wait(async_handle_t handle)
+{
+  pthread_mutex_lock(&engine.lock);
+  while (!handle->done)
+  {
+    pthread_cond_wait(&engine.finished, &engine.lock);
+  }
+  pthread_mutex_unlock(&engine.lock);
+}
+
+void async_copy_release(async_handle_t handle)
+{
+  if (!handle)
+  {
+    return;
+  }
+  async_copy_wait(handle);
+  free_words((int32_t *) handle);
+}
@@ -18,9 +18,15 @@
  */
 
 #include <stdint.h>
+#ifdef HOST
+#include <pthread.h>
+#include <sched.h>
+#include "async_copy.h"
+#endif
 #include "course1.h"
 #include "platform.h"
 #include "memory.h"
+#include "ring_buffer.h"
 #include "data.h"
 #include "stats.h"
 
@@ -221,6 +227,70 @@ int8_t test_memmove3() {
 
 }
 
+int8_t test_memmove_overlap()
+{
+  size_t i;
+  size_t length;
+  size_t base;
+  size_t shift;
+  size_t src_off;
+  size_t dst_off;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t expected;
+  uint8_t * set;
+
+  PRINTF("test_memmove_overlap()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+
+  for (length = 0; length <= MEM_SWEEP_MAX_LENGTH; length++)
+  {
+    for (base = 0; base < MEM_SWEEP_ALIGN; base += 5)
+    {
+      for (shift = 1; shift < 2 * MEM_SWEEP_ALIGN; shift++)
+      {
+        /* shift below MEM_SWEEP_ALIGN moves up, the rest moves down */
+        if (shift < MEM_SWEEP_ALIGN)
+        {
+          src_off = base;
+          dst_off = base + shift;
+        }
+        else
+        {
+          src_off = base + shift - MEM_SWEEP_ALIGN + 1;
+          dst_off = base;
+        }
+
+        for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+        {
+          set[i] = (uint8_t)(i * 3 + 1);
+        }
+
+        my_memmove(set + src_off, set + dst_off, length);
+
+        for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+        {
+          expected = (uint8_t)(i * 3 + 1);
+          if ((i >= dst_off) && (i < dst_off + length))
+          {
+            expected = (uint8_t)((i - dst_off + src_off) * 3 + 1);
+          }
+          if (set[i] != expected)
+          {
+            ret = TEST_ERROR;
+          }
+        }
+      }
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
 int8_t test_memcopy() {
   uint8_t i;
   int8_t ret = TEST_NO_ERROR;
@@ -259,6 +329,66 @@ int8_t test_memcopy() {
   return ret;
 }
 
+int8_t test_memcopy_align()
+{
+  size_t i;
+  size_t length;
+  size_t src_off;
+  size_t dst_off;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t expected;
+  uint8_t * set;
+  uint8_t * ptra;
+  uint8_t * ptrb;
+
+  PRINTF("test_memcopy_align()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+  ptra = &set[0];
+  ptrb = &set[MEM_SWEEP_SIZE_B / 2];
+
+  /* Source half holds test values, destination half a guard pattern */
+  for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+  {
+    ptra[i] = (uint8_t)(i * 7 + 1);
+  }
+
+  for (length = 0; length <= MEM_SWEEP_MAX_LENGTH; length++)
+  {
+    for (src_off = 0; src_off < MEM_SWEEP_ALIGN; src_off++)
+    {
+      for (dst_off = 0; dst_off < MEM_SWEEP_ALIGN; dst_off++)
+      {
+        for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+        {
+          ptrb[i] = 0xEE;
+        }
+
+        my_memcopy(ptra + src_off, ptrb + dst_off, length);
+
+        for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+        {
+          expected = 0xEE;
+          if ((i >= dst_off) && (i < dst_off + length))
+          {
+            expected = ptra[i - dst_off + src_off];
+          }
+          if (ptrb[i] != expected)
+          {
+            ret = TEST_ERROR;
+          }
+        }
+      }
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
 int8_t test_memset() 
 {
   uint8_t i;
@@ -305,6 +435,62 @@ int8_t test_memset()
   return ret;
 }
 
+int8_t test_memset_align()
+{
+  size_t i;
+  size_t length;
+  size_t offset;
+  size_t threshold;
+  uint8_t pass;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t expected;
+  uint8_t * set;
+
+  PRINTF("test_memset_align()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+
+  threshold = get_memset_nt_threshold();
+  for (pass = 0; pass < 2; pass++)
+  {
+    /* second pass streams every fill of 64 bytes and more */
+    set_memset_nt_threshold((pass == 0) ? threshold : 64);
+
+    for (length = 0; length <= MEM_SWEEP_MAX_LENGTH; length++)
+    {
+      for (offset = 0; offset < MEM_SWEEP_ALIGN; offset++)
+      {
+        for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+        {
+          set[i] = 0xEE;
+        }
+
+        my_memset(set + offset, length, (uint8_t)(length + 1));
+
+        for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+        {
+          expected = 0xEE;
+          if ((i >= offset) && (i < offset + length))
+          {
+            expected = (uint8_t)(length + 1);
+          }
+          if (set[i] != expected)
+          {
+            ret = TEST_ERROR;
+          }
+        }
+      }
+    }
+  }
+  set_memset_nt_threshold(threshold);
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
 int8_t test_reverse()
 {
   uint8_t i;
@@ -341,6 +527,1636 @@ int8_t test_reverse()
   return ret;
 }
 
+int8_t test_reverse_lengths()
+{
+  size_t i;
+  size_t length;
+  size_t offset;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t expected;
+  uint8_t * set;
+
+  PRINTF("test_reverse_lengths()\n");
+  set = (uint8_t*)reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+
+  for (length = 0; length <= MEM_SWEEP_SIZE_B - MEM_SWEEP_ALIGN; length++)
+  {
+    for (offset = 0; offset < MEM_SWEEP_ALIGN; offset += 3)
+    {
+      for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+      {
+        set[i] = (uint8_t)(i * 5 + 2);
+      }
+
+      my_reverse(set + offset, length);
+
+      for (i = 0; i < MEM_SWEEP_SIZE_B; i++)
+      {
+        expected = (uint8_t)(i * 5 + 2);
+        if ((i >= offset) && (i < offset + length))
+        {
+          expected = (uint8_t)((2 * offset + length - 1 - i) * 5 + 2);
+        }
+        if (set[i] != expected)
+        {
+          ret = TEST_ERROR;
+        }
+      }
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
+int8_t test_arena()
+{
+  int8_t ret = TEST_NO_ERROR;
+  int32_t * ptra;
+  int32_t * ptrb;
+  int32_t * ptrc;
+  size_t mark;
+
+  PRINTF("test_arena()\n");
+  if (arena_init(NULL, ARENA_TEST_SIZE_W) != MEM_NO_ERROR)
+  {
+    return TEST_ERROR;
+  }
+
+  ptra = reserve_words(MEM_SET_SIZE_W);
+  ptrb = reserve_words(DATA_SET_SIZE_W);
+  if ((! ptra) || (! ptrb) || (ptrb < ptra + MEM_SET_SIZE_W))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* rewind to a mark gives back everything reserved after it */
+  mark = arena_mark();
+  ptrc = reserve_words(MEM_SET_SIZE_W);
+  arena_rewind(mark);
+  if (reserve_words(MEM_SET_SIZE_W) != ptrc)
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* freeing the most recent block gives it back too */
+  free_words(ptrc);
+  if (arena_mark() != mark)
+  {
+    ret = TEST_ERROR;
+  }
+
+  if (reserve_words(ARENA_TEST_SIZE_W) != NULL)
+  {
+    ret = TEST_ERROR;
+  }
+
+  arena_reset();
+  if ((arena_used() != 0) || (reserve_words(1) != ptra))
+  {
+    ret = TEST_ERROR;
+  }
+
+  arena_release();
+  return ret;
+}
+
+int8_t test_pool()
+{
+  uint8_t i;
+  int8_t ret = TEST_NO_ERROR;
+  mem_pool_t pool;
+  int32_t * blocks[POOL_TEST_BLOCKS];
+  int32_t * extra;
+  int32_t * again;
+
+  PRINTF("test_pool()\n");
+  if (pool_init(&pool, NULL, MEM_SET_SIZE_W, POOL_TEST_BLOCKS) != MEM_NO_ERROR)
+  {
+    return TEST_ERROR;
+  }
+  pool_attach(&pool);
+
+  for (i = 0; i < POOL_TEST_BLOCKS; i++)
+  {
+    blocks[i] = reserve_words(MEM_SET_SIZE_W);
+    if ((blocks[i] < pool.storage) ||
+        (blocks[i] >= pool.storage + pool.block_words * POOL_TEST_BLOCKS))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  /* the pool is empty now, the next block comes from elsewhere */
+  extra = reserve_words(MEM_SET_SIZE_W);
+  if ((! extra ) || (pool_in_use(&pool) != POOL_TEST_BLOCKS))
+  {
+    ret = TEST_ERROR;
+  }
+  free_words(extra);
+
+  /* a freed block is the first one handed out again */
+  free_words(blocks[1]);
+  if (pool_in_use(&pool) != POOL_TEST_BLOCKS - 1)
+  {
+    ret = TEST_ERROR;
+  }
+  again = reserve_words(MEM_SET_SIZE_W - 1);
+  if (again != blocks[1])
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (i = 0; i < POOL_TEST_BLOCKS; i++)
+  {
+    free_words(blocks[i]);
+  }
+  if ((pool_in_use(&pool) != 0) || (pool_peak(&pool) != POOL_TEST_BLOCKS))
+  {
+    ret = TEST_ERROR;
+  }
+
+  pool_destroy(&pool);
+  return ret;
+}
+
+#if defined (HOST) && !defined (MEMORY_ARENA_WORDS)
+static int32_t * thread_test_blocks[THREAD_TEST_THREADS][THREAD_TEST_BLOCKS];
+static int8_t thread_test_results[THREAD_TEST_THREADS];
+
+/* Size in words of block (b) of a thread */
+static size_t thread_test_size(size_t b)
+{
+  return 1 + (b * 37) % 600;
+}
+
+static void * thread_test_reserve(void * arg)
+{
+  size_t t = (size_t) arg;
+  size_t b;
+  size_t i;
+  int32_t * block;
+
+  for (b = 0; b < THREAD_TEST_BLOCKS; b++)
+  {
+    block = reserve_words(thread_test_size(b));
+    if (! block )
+    {
+      thread_test_results[t] = TEST_ERROR;
+    }
+    else
+    {
+      for (i = 0; i < thread_test_size(b); i++)
+      {
+        block[i] = (int32_t)((t << 16) | b);
+      }
+    }
+    thread_test_blocks[t][b] = block;
+  }
+  return NULL;
+}
+
+/* Checks and frees the blocks reserved by the next thread */
+static void * thread_test_free(void * arg)
+{
+  size_t t = (size_t) arg;
+  size_t owner = (t + 1) % THREAD_TEST_THREADS;
+  size_t b;
+  size_t i;
+  int32_t * block;
+
+  for (b = 0; b < THREAD_TEST_BLOCKS; b++)
+  {
+    block = thread_test_blocks[owner][b];
+    if (! block )
+    {
+      continue;
+    }
+    for (i = 0; i < thread_test_size(b); i++)
+    {
+      if (block[i] != (int32_t)((owner << 16) | b))
+      {
+        thread_test_results[t] = TEST_ERROR;
+      }
+    }
+    free_words(block);
+    thread_test_blocks[owner][b] = NULL;
+  }
+  return NULL;
+}
+#endif
+
+int8_t test_words_threads()
+{
+  int8_t ret = TEST_NO_ERROR;
+  /* a build-time arena is not thread safe, so there is nothing to test */
+#if defined (HOST) && !defined (MEMORY_ARENA_WORDS)
+  pthread_t threads[THREAD_TEST_THREADS];
+  size_t t;
+  uint8_t round;
+
+  PRINTF("test_words_threads()\n");
+  for (round = 0; round < THREAD_TEST_ROUNDS; round++)
+  {
+    for (t = 0; t < THREAD_TEST_THREADS; t++)
+    {
+      thread_test_results[t] = TEST_NO_ERROR;
+      pthread_create(&threads[t], NULL, thread_test_reserve, (void *) t);
+    }
+    for (t = 0; t < THREAD_TEST_THREADS; t++)
+    {
+      pthread_join(threads[t], NULL);
+    }
+    for (t = 0; t < THREAD_TEST_THREADS; t++)
+    {
+      pthread_create(&threads[t], NULL, thread_test_free, (void *) t);
+    }
+    for (t = 0; t < THREAD_TEST_THREADS; t++)
+    {
+      pthread_join(threads[t], NULL);
+      ret |= thread_test_results[t];
+    }
+  }
+#endif
+  return ret;
+}
+
+int8_t test_instrument()
+{
+  uint8_t i;
+  int8_t ret = TEST_NO_ERROR;
+  mem_stats_t before;
+  mem_stats_t after;
+  int32_t * block;
+  uint8_t set[MEM_SET_SIZE_B];
+
+  PRINTF("test_instrument()\n");
+  if (memory_get_stats(&before) != MEM_NO_ERROR)
+  {
+    /* not an instrumented build */
+    return TEST_NO_ERROR;
+  }
+
+  block = reserve_words(DATA_SET_SIZE_W);
+  memory_get_stats(&after);
+  if ((after.reserve_calls != before.reserve_calls + 1) ||
+      (after.blocks_in_flight != before.blocks_in_flight + 1) ||
+      (after.bytes_in_flight != before.bytes_in_flight + DATA_SET_SIZE_W * sizeof(int32_t)) ||
+      (after.peak_bytes < after.bytes_in_flight) ||
+      (after.size_histogram[2] != before.size_histogram[2] + 1))
+  {
+    ret = TEST_ERROR;
+  }
+  free_words(block);
+
+  /* every merge step of sort_merge reserves and frees a help block */
+  for (i = 0; i < MEM_SET_SIZE_B; i++)
+  {
+    set[i] = (uint8_t)(i * 7);
+  }
+  sort_merge(set, MEM_SET_SIZE_B);
+
+  memory_get_stats(&after);
+  if ((after.reserve_calls < before.reserve_calls + MEM_SET_SIZE_B) ||
+      (after.free_calls != before.free_calls + (after.reserve_calls - before.reserve_calls)) ||
+      (after.blocks_in_flight != before.blocks_in_flight) ||
+      (after.bytes_in_flight != before.bytes_in_flight))
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
+int8_t test_memmove_sg()
+{
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t * set;
+  uint8_t * src;
+  uint8_t * dst;
+  size_t moved;
+  mem_desc_t list[SG_TEST_DESCS];
+
+  PRINTF("test_memmove_sg()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+  src = &set[0];
+  dst = &set[MEM_SWEEP_SIZE_B / 2];
+
+  for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+  {
+    src[i] = i;
+    dst[i] = 0;
+  }
+
+  /* src[0..48) -> dst[0..48) in three pieces that merge, given out of order */
+  list[0] = (mem_desc_t){ src + 32, dst + 32, 16, 0 };
+  list[1] = (mem_desc_t){ src + 0, dst + 0, 20, 0 };
+  list[2] = (mem_desc_t){ src + 20, dst + 20, 12, 0 };
+  /* src[64..80) -> dst[100..116), does not continue anything */
+  list[3] = (mem_desc_t){ src + 64, dst + 100, 16, 0 };
+  /* src[160..200) -> src[168..208), overlaps itself */
+  list[4] = (mem_desc_t){ src + 160, src + 168, 40, 0 };
+  /* empty region */
+  list[5] = (mem_desc_t){ src + 250, dst + 250, 0, 0 };
+
+  moved = my_memmove_sg(list, SG_TEST_DESCS);
+  if (moved != 48 + 16 + 40)
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (i = 0; i < SG_TEST_DESCS; i++)
+  {
+    if (! list[i].done )
+    {
+      ret = TEST_ERROR;
+    }
+  }
+  for (i = 0; i < 48; i++)
+  {
+    if (dst[i] != i)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+  for (i = 0; i < 16; i++)
+  {
+    if (dst[100 + i] != 64 + i)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+  for (i = 0; i < 40; i++)
+  {
+    if (src[168 + i] != 160 + i)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
+#if defined (HOST)
+static void async_test_callback(async_handle_t handle, void * context)
+{
+  (void) handle;
+  (*(uint32_t *) context)++;
+}
+#endif
+
+int8_t test_async_copy()
+{
+  int8_t ret = TEST_NO_ERROR;
+#if defined (HOST)
+  static uint8_t src[ASYNC_TEST_SIZE_B];
+  static uint8_t dst[ASYNC_TEST_SIZE_B];
+  static uint8_t set[ASYNC_TEST_SIZE_B];
+  async_handle_t copy;
+  async_handle_t fill;
+  uint32_t copy_calls = 0;
+  uint32_t fill_calls = 0;
+  size_t i;
+
+  PRINTF("test_async_copy()\n");
+  for (i = 0; i < ASYNC_TEST_SIZE_B; i++)
+  {
+    src[i] = (uint8_t)(i * 13 + 1);
+    dst[i] = 0;
+    set[i] = 0;
+  }
+
+  if (async_copy_init(ASYNC_TEST_THREADS, ASYNC_TEST_CHUNK_B) != MEM_NO_ERROR)
+  {
+    return TEST_ERROR;
+  }
+
+  /* the last chunk of the copy is a partial one */
+  copy = async_copy_submit(src, dst, ASYNC_TEST_SIZE_B - 3, async_test_callback, &copy_calls);
+  fill = async_fill_submit(set, ASYNC_TEST_SIZE_B, 0xA5, async_test_callback, &fill_calls);
+  if (!copy || !fill)
+  {
+    ret = TEST_ERROR;
+  }
+
+  async_copy_wait(copy);
+  while (!async_copy_poll(fill))
+  {
+  }
+
+  for (i = 0; i < ASYNC_TEST_SIZE_B; i++)
+  {
+    if ((i < ASYNC_TEST_SIZE_B - 3 && dst[i] != src[i]) ||
+        (i >= ASYNC_TEST_SIZE_B - 3 && dst[i] != 0) ||
+        (set[i] != 0xA5))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+  if ((copy_calls != 1) || (fill_calls != 1))
+  {
+    ret = TEST_ERROR;
+  }
+
+  async_copy_release(copy);
+  async_copy_release(fill);
+  async_copy_shutdown();
+
+  /* without workers a request is done by the time submit returns */
+  copy = async_copy_submit(dst, src, ASYNC_TEST_SIZE_B, NULL, NULL);
+  if (!copy || !async_copy_poll(copy))
+  {
+    ret = TEST_ERROR;
+  }
+  async_copy_release(copy);
+#endif
+  return ret;
+}
+
+int8_t test_memory_parallel()
+{
+  static uint8_t src[PARALLEL_TEST_SIZE_B];
+  static uint8_t dst[PARALLEL_TEST_SIZE_B];
+  int8_t ret = TEST_NO_ERROR;
+  size_t length = PARALLEL_TEST_SIZE_B - 8;
+  size_t threshold;
+  size_t i;
+
+  PRINTF("test_memory_parallel()\n");
+  for (i = 0; i < PARALLEL_TEST_SIZE_B; i++)
+  {
+    src[i] = (uint8_t)(i * 7 + (i >> 8));
+    dst[i] = 0x5A;
+  }
+
+  my_memcopy_parallel(src + 1, dst + 3, length, PARALLEL_TEST_THREADS);
+  for (i = 0; i < PARALLEL_TEST_SIZE_B; i++)
+  {
+    if ((i >= 3) && (i < length + 3) ? (dst[i] != src[i - 2]) : (dst[i] != 0x5A))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  my_memset_parallel(dst + 3, length, 0xC3, PARALLEL_TEST_THREADS);
+  for (i = 0; i < PARALLEL_TEST_SIZE_B; i++)
+  {
+    if ((i >= 3) && (i < length + 3) ? (dst[i] != 0xC3) : (dst[i] != 0x5A))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  /* shorter than a page: done on the calling thread */
+  my_memzero_parallel(dst + 3, 100, PARALLEL_TEST_THREADS);
+  my_memzero_parallel(dst + 103, length - 100, 0);
+  for (i = 0; i < PARALLEL_TEST_SIZE_B; i++)
+  {
+    if ((i >= 3) && (i < length + 3) ? (dst[i] != 0) : (dst[i] != 0x5A))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  threshold = get_parallel_threshold();
+  set_parallel_threshold(PARALLEL_TEST_SIZE_B / 2);
+  my_memcopy(src, dst, PARALLEL_TEST_SIZE_B);
+  set_parallel_threshold(threshold);
+  if (my_memcmp(src, dst, PARALLEL_TEST_SIZE_B) != 0)
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
+int8_t test_memcmp_search()
+{
+  size_t i;
+  size_t length;
+  size_t off;
+  size_t pos[3];
+  uint8_t p;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t * set;
+  uint8_t * ptra;
+  uint8_t * ptrb;
+
+  PRINTF("test_memcmp_search()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+  ptra = &set[0];
+  ptrb = &set[MEM_SWEEP_SIZE_B / 2];
+
+  for (length = 0; length <= MEM_SWEEP_MAX_LENGTH; length++)
+  {
+    pos[0] = 0;
+    pos[1] = length / 2;
+    pos[2] = length - 1;
+    for (off = 1; off <= MEM_SWEEP_ALIGN; off++)
+    {
+      for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+      {
+        ptra[i] = (uint8_t)(i * 7 + 1);
+        ptrb[i] = ptra[i];
+      }
+      /* differences right outside the compared range */
+      ptrb[off - 1] ^= 0xFF;
+      ptrb[off + length] ^= 0xFF;
+
+      if ((my_mismatch(ptra + off, ptrb + off, length) != length) ||
+          (my_memcmp(ptra + off, ptrb + off, length) != 0))
+      {
+        ret = TEST_ERROR;
+      }
+
+      for (p = 0; (p < 3) && (length != 0); p++)
+      {
+        ptrb[off + pos[p]] ^= 0x80;
+        if ((my_mismatch(ptra + off, ptrb + off, length) != pos[p]) ||
+            (my_memcmp(ptra + off, ptrb + off, length) != (int32_t) ptra[off + pos[p]] - ptrb[off + pos[p]]) ||
+            (my_memcmp(ptrb + off, ptra + off, length) != (int32_t) ptrb[off + pos[p]] - ptra[off + pos[p]]))
+        {
+          ret = TEST_ERROR;
+        }
+        ptrb[off + pos[p]] ^= 0x80;
+      }
+
+      /* search: the value only sits right outside the range */
+      for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+      {
+        ptra[i] = 0x11;
+      }
+      ptra[off - 1] = 0xAB;
+      ptra[off + length] = 0xAB;
+      if ((my_memchr(ptra + off, length, 0xAB) != NULL) ||
+          (my_memrchr(ptra + off, length, 0xAB) != NULL))
+      {
+        ret = TEST_ERROR;
+      }
+
+      for (p = 0; (p < 3) && (length != 0); p++)
+      {
+        ptra[off + pos[p]] = 0xAB;
+        if ((my_memchr(ptra + off, length, 0xAB) != ptra + off + pos[0]) ||
+            (my_memrchr(ptra + off, length, 0xAB) != ptra + off + pos[p]))
+        {
+          ret = TEST_ERROR;
+        }
+      }
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
+int8_t test_memcopy_checksum()
+{
+  uint8_t check[] = "123456789";
+  size_t i;
+  size_t split;
+  int8_t ret = TEST_NO_ERROR;
+  uint32_t whole[3];
+  uint32_t part[3];
+  uint8_t * set;
+  uint8_t * ptra;
+  uint8_t * ptrb;
+
+  PRINTF("test_memcopy_checksum()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+  ptra = &set[0];
+  ptrb = &set[MEM_SWEEP_SIZE_B / 2];
+
+  if ((my_memcopy_crc32(check, ptrb, 9, 0) != 0xCBF43926) ||
+      (my_memcopy_crc32c(check, ptrb, 9, 0) != 0xE3069283) ||
+      (my_memcopy_adler32(check, ptrb, 9, 1) != 0x091E01DE) ||
+      (my_memcmp(check, ptrb, 9) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+  {
+    ptra[i] = (uint8_t)(i * 7 + 1);
+  }
+  my_memzero(ptrb, MEM_SWEEP_SIZE_B / 2);
+  whole[0] = my_memcopy_crc32(ptra + 1, ptrb + 1, MEM_SWEEP_MAX_LENGTH, 0);
+  whole[1] = my_memcopy_crc32c(ptra + 1, ptrb + 1, MEM_SWEEP_MAX_LENGTH, 0);
+  whole[2] = my_memcopy_adler32(ptra + 1, ptrb + 1, MEM_SWEEP_MAX_LENGTH, 1);
+  if ((my_memcmp(ptra + 1, ptrb + 1, MEM_SWEEP_MAX_LENGTH) != 0) || (ptrb[0] != 0) ||
+      (ptrb[MEM_SWEEP_MAX_LENGTH + 1] != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (split = 0; split <= MEM_SWEEP_MAX_LENGTH; split++)
+  {
+    part[0] = my_memcopy_crc32(ptra + 1, ptrb + 1, split, 0);
+    part[0] = my_memcopy_crc32(ptra + 1 + split, ptrb + 1 + split, MEM_SWEEP_MAX_LENGTH - split, part[0]);
+    part[1] = my_memcopy_crc32c(ptra + 1, ptrb + 1, split, 0);
+    part[1] = my_memcopy_crc32c(ptra + 1 + split, ptrb + 1 + split, MEM_SWEEP_MAX_LENGTH - split, part[1]);
+    part[2] = my_memcopy_adler32(ptra + 1, ptrb + 1, split, 1);
+    part[2] = my_memcopy_adler32(ptra + 1 + split, ptrb + 1 + split, MEM_SWEEP_MAX_LENGTH - split, part[2]);
+    if ((part[0] != whole[0]) || (part[1] != whole[1]) || (part[2] != whole[2]))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
+int8_t test_bswap()
+{
+  size_t i;
+  size_t count;
+  size_t width;
+  size_t off;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t * set;
+  uint8_t * ptra;
+  uint8_t * ptrb;
+
+  PRINTF("test_bswap()\n");
+  set = (uint8_t*) reserve_words(MEM_SWEEP_SIZE_W);
+  if (! set )
+  {
+    return TEST_ERROR;
+  }
+  ptra = &set[0];
+  ptrb = &set[MEM_SWEEP_SIZE_B / 2];
+
+  for (width = 2; width <= 8; width *= 2)
+  {
+    for (count = 0; count <= MEM_SWEEP_MAX_LENGTH / width; count++)
+    {
+      for (off = 0; off < 3; off++)
+      {
+        for (i = 0; i < MEM_SWEEP_SIZE_B / 2; i++)
+        {
+          ptra[i] = (uint8_t)(i * 7 + 1);
+          ptrb[i] = 0xEE;
+        }
+
+        switch (width)
+        {
+          case 2: my_bswap16(ptra + off, ptrb + off, count); break;
+          case 4: my_bswap32(ptra + off, ptrb + off, count); break;
+          default: my_bswap64(ptra + off, ptrb + off, count); break;
+        }
+        /* element e, byte k comes from element e, byte width - 1 - k */
+        for (i = 0; i < count * width; i++)
+        {
+          if (ptrb[off + i] != ptra[off + i - (i % width) + width - 1 - (i % width)])
+          {
+            ret = TEST_ERROR;
+          }
+        }
+        if ((ptrb[off + count * width] != 0xEE) || ((off != 0) && (ptrb[off - 1] != 0xEE)))
+        {
+          ret = TEST_ERROR;
+        }
+
+        /* in place, the result has to match the out of place one */
+        switch (width)
+        {
+          case 2: my_bswap16(ptra + off, ptra + off, count); break;
+          case 4: my_bswap32(ptra + off, ptra + off, count); break;
+          default: my_bswap64(ptra + off, ptra + off, count); break;
+        }
+        if (my_memcmp(ptra + off, ptrb + off, count * width) != 0)
+        {
+          ret = TEST_ERROR;
+        }
+      }
+    }
+  }
+
+  free_words( (int32_t*)set );
+  return ret;
+}
+
+#if defined (HOST)
+/* Producer side of test_ring_buffer: a counting byte stream */
+static void * ring_test_producer(void * arg)
+{
+  ring_buffer_t * ring = (ring_buffer_t *) arg;
+  uint8_t chunk[RING_TEST_CAPACITY];
+  size_t sent = 0;
+  size_t length;
+  size_t i;
+
+  while (sent < RING_TEST_STREAM_B)
+  {
+    length = 1 + (sent % (RING_TEST_CAPACITY - 1));
+    if (length > RING_TEST_STREAM_B - sent)
+    {
+      length = RING_TEST_STREAM_B - sent;
+    }
+    for (i = 0; i < length; i++)
+    {
+      chunk[i] = (uint8_t)(sent + i);
+    }
+    i = 0;
+    while (i < length)
+    {
+      i += ring_write(ring, chunk + i, length - i);
+      if (i < length)
+      {
+        /* full: let the consumer run, the host may have one CPU only */
+        sched_yield();
+      }
+    }
+    sent += length;
+  }
+  return NULL;
+}
+#endif
+
+int8_t test_ring_buffer()
+{
+  ring_buffer_t ring;
+  uint8_t in[RING_TEST_CAPACITY];
+  uint8_t out[RING_TEST_CAPACITY];
+  uint8_t * region;
+  size_t length;
+  size_t step;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_ring_buffer()\n");
+  if ((ring_init(&ring, NULL, RING_TEST_CAPACITY - 1) != MEM_ERROR) ||
+      (ring_init(&ring, NULL, RING_TEST_CAPACITY) != MEM_NO_ERROR))
+  {
+    return TEST_ERROR;
+  }
+
+  /* bulk calls: sizes that do not divide the capacity make every
+   * possible wrap point show up */
+  for (step = 1; step <= RING_TEST_CAPACITY; step++)
+  {
+    for (i = 0; i < step; i++)
+    {
+      in[i] = (uint8_t)(step * 3 + i);
+    }
+    if ((ring_write(&ring, in, step) != step) || (ring_used(&ring) != step) ||
+        (ring_write(&ring, in, RING_TEST_CAPACITY) != RING_TEST_CAPACITY - step) ||
+        (ring_free(&ring) != 0))
+    {
+      ret = TEST_ERROR;
+    }
+    if ((ring_read(&ring, out, step) != step) || (my_memcmp(in, out, step) != 0))
+    {
+      ret = TEST_ERROR;
+    }
+    /* drain the filler */
+    if ((ring_read(&ring, out, RING_TEST_CAPACITY) != RING_TEST_CAPACITY - step) ||
+        (ring_used(&ring) != 0) || (ring_read(&ring, out, 1) != 0))
+    {
+      ret = TEST_ERROR;
+    }
+    /* move the indexes so the next step starts at another offset */
+    ring_write(&ring, in, step % 7);
+    ring_read(&ring, out, step % 7);
+  }
+
+  /* zero-copy: fill the free space through write_peek in two regions */
+  length = 0;
+  for (step = 0; step < 2; step++)
+  {
+    region = ring_write_peek(&ring, &i);
+    my_memset(region, i, (uint8_t)(0x40 + step));
+    ring_write_commit(&ring, i);
+    length += i;
+  }
+  if ((length != RING_TEST_CAPACITY) || (ring_free(&ring) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+  ring_write_peek(&ring, &i);
+  if (i != 0)
+  {
+    ret = TEST_ERROR;
+  }
+  region = ring_read_peek(&ring, &i);
+  if ((i == 0) || (my_memchr(region, i, 0x41) != NULL))
+  {
+    ret = TEST_ERROR;
+  }
+  ring_read_commit(&ring, i);
+  region = ring_read_peek(&ring, &length);
+  if ((i + length != RING_TEST_CAPACITY) ||
+      ((length != 0) && (my_memchr(region, length, 0x40) != NULL)))
+  {
+    ret = TEST_ERROR;
+  }
+  ring_read_commit(&ring, length);
+
+#if defined (HOST)
+  {
+    pthread_t producer;
+    size_t received = 0;
+
+    pthread_create(&producer, NULL, ring_test_producer, &ring);
+    while (received < RING_TEST_STREAM_B)
+    {
+      region = ring_read_peek(&ring, &length);
+      for (i = 0; i < length; i++)
+      {
+        if (region[i] != (uint8_t)(received + i))
+        {
+          ret = TEST_ERROR;
+        }
+      }
+      ring_read_commit(&ring, length);
+      received += length;
+      if (length == 0)
+      {
+        sched_yield();
+      }
+    }
+    pthread_join(producer, NULL);
+  }
+#endif
+
+  ring_destroy(&ring);
+  return ret;
+}
+
+int8_t test_slices()
+{
+  mem_slice_t whole;
+  mem_slice_t half;
+  mem_slice_t quarter;
+  mem_slice_t shared;
+  mem_slice_t bad;
+  mem_stats_t before;
+  mem_stats_t after;
+  uint8_t instrumented;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_slices()\n");
+  instrumented = (memory_get_stats(&before) == MEM_NO_ERROR);
+
+  whole = slice_reserve(MEM_SET_SIZE_B);
+  if (whole.data == NULL)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < whole.length; i++)
+  {
+    whole.data[i] = (uint8_t)(i % 10);
+  }
+
+  half = slice_sub(whole, MEM_SET_SIZE_B / 2, MEM_SET_SIZE_B / 2);
+  quarter = slice_sub(half, MEM_SET_SIZE_B / 4, MEM_SET_SIZE_B / 4);
+  shared = slice_retain(quarter);
+  bad = slice_sub(half, 1, MEM_SET_SIZE_B / 2);
+  if ((half.data != whole.data + MEM_SET_SIZE_B / 2) ||
+      (quarter.data != whole.data + 3 * MEM_SET_SIZE_B / 4) ||
+      (quarter.length != MEM_SET_SIZE_B / 4) || (shared.data != quarter.data) ||
+      (bad.data != NULL) || (slice_refs(bad) != 0) || (slice_refs(whole) != 4))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* a slice is handed to the stats code as it is */
+  if (find_mean(quarter.data, (int) quarter.length) != find_mean(whole.data + 3 * MEM_SET_SIZE_B / 4, MEM_SET_SIZE_B / 4))
+  {
+    ret = TEST_ERROR;
+  }
+
+  slice_release(&whole);
+  slice_release(&half);
+  slice_release(&bad);
+  if ((whole.data != NULL) || (slice_refs(quarter) != 2) || (quarter.data[0] != (3 * MEM_SET_SIZE_B / 4) % 10))
+  {
+    ret = TEST_ERROR;
+  }
+  slice_release(&quarter);
+  slice_release(&shared);
+
+  if (instrumented)
+  {
+    memory_get_stats(&after);
+    if ((after.blocks_in_flight != before.blocks_in_flight) ||
+        (after.reserve_calls != before.reserve_calls + 1))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  return ret;
+}
+
+int8_t test_reserve_aligned()
+{
+  int32_t * block;
+  size_t alignment;
+  size_t length;
+  uint8_t flags;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_reserve_aligned()\n");
+  if (reserve_words_aligned(1, 24) != NULL)
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (alignment = 4; alignment <= 256; alignment *= 2)
+  {
+    for (length = 1; length <= DATA_SET_SIZE_W; length += 7)
+    {
+      block = reserve_words_aligned(length, alignment);
+      if ((block == NULL) || (((uintptr_t) block & (alignment - 1)) != 0))
+      {
+        return TEST_ERROR;
+      }
+      my_memset((uint8_t *) block, length * sizeof(int32_t), 0xA5);
+      free_words_aligned(block);
+    }
+  }
+
+  /* a few MB are more than the MSP432 has */
+#if defined (HOST)
+  for (flags = 0; flags <= (MEM_LARGE_HUGE_PAGES | MEM_LARGE_THP | MEM_LARGE_POPULATE); flags++)
+  {
+    block = reserve_words_large(LARGE_TEST_SIZE_W, flags);
+    if ((block == NULL) || (((uintptr_t) block & 63) != 0))
+    {
+      ret = TEST_ERROR;
+      continue;
+    }
+    my_memset((uint8_t *) block, LARGE_TEST_SIZE_W * sizeof(int32_t), (uint8_t) flags);
+    if (my_memrchr((uint8_t *) block, LARGE_TEST_SIZE_W * sizeof(int32_t), (uint8_t)(flags + 1)) != NULL)
+    {
+      ret = TEST_ERROR;
+    }
+    free_words_large(block);
+  }
+#else
+  (void) flags;
+#endif
+
+  return ret;
+}
+
+/* Checks that word i of (words) is i */
+static int8_t resize_check(const int32_t * words, size_t length)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (words[i] != (int32_t) i)
+    {
+      return TEST_ERROR;
+    }
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_resize_words()
+{
+  int32_t chunk[7];
+  int32_t * block;
+  int32_t * grown;
+  mem_wordbuf_t buf;
+  size_t length;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_resize_words()\n");
+  block = resize_words(NULL, 0, 1);
+  if (block == NULL)
+  {
+    return TEST_ERROR;
+  }
+  block[0] = 0;
+  for (length = 1; length < DATA_SET_SIZE_W; length++)
+  {
+    grown = resize_words(block, length, length + 1);
+    if (grown == NULL)
+    {
+      free_words(block);
+      return TEST_ERROR;
+    }
+    block = grown;
+    block[length] = (int32_t) length;
+    ret |= resize_check(block, length + 1);
+  }
+  /* shrinking keeps the block */
+  if (resize_words(block, DATA_SET_SIZE_W, 1) != block)
+  {
+    ret = TEST_ERROR;
+  }
+  free_words(block);
+
+  wordbuf_init(&buf);
+  for (i = 0; i < RESIZE_TEST_WORDS; i += 7)
+  {
+    for (length = 0; length < 7; length++)
+    {
+      chunk[length] = (int32_t)(i + length);
+    }
+    if (wordbuf_append(&buf, chunk, 7) != MEM_NO_ERROR)
+    {
+      wordbuf_free(&buf);
+      return TEST_ERROR;
+    }
+  }
+  if ((buf.length != i) || (buf.capacity < buf.length) || (buf.large != 0))
+  {
+    ret = TEST_ERROR;
+  }
+  ret |= resize_check(buf.data, buf.length);
+  wordbuf_free(&buf);
+  if ((buf.data != NULL) || (buf.capacity != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* tens of MB are more than the MSP432 has */
+#if defined (HOST)
+  block = reserve_words_large(DATA_SET_SIZE_W, MEM_LARGE_THP);
+  if (block == NULL)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < DATA_SET_SIZE_W; i++)
+  {
+    block[i] = (int32_t) i;
+  }
+  grown = resize_words_large(block, DATA_SET_SIZE_W, RESIZE_TEST_GROWN_W);
+  if (grown == NULL)
+  {
+    free_words_large(block);
+    return TEST_ERROR;
+  }
+  ret |= resize_check(grown, DATA_SET_SIZE_W);
+  grown[RESIZE_TEST_GROWN_W - 1] = 1;
+  free_words_large(grown);
+#endif
+
+  /* the small phase needs more than the build-time arena holds */
+#if defined (HOST) && !defined (MEMORY_ARENA_WORDS)
+  wordbuf_init(&buf);
+  for (length = MEMORY_WORDBUF_LARGE_WORDS / 2; length <= MEMORY_WORDBUF_LARGE_WORDS; length *= 2)
+  {
+    /* first a small block, then the switch to a mapped one */
+    i = buf.length;
+    if (wordbuf_resize(&buf, length) != MEM_NO_ERROR)
+    {
+      wordbuf_free(&buf);
+      return TEST_ERROR;
+    }
+    for (; i < buf.length; i++)
+    {
+      buf.data[i] = (int32_t) i;
+    }
+  }
+  while (buf.length < buf.capacity)
+  {
+    chunk[0] = (int32_t) buf.length;
+    if (wordbuf_append(&buf, chunk, 1) != MEM_NO_ERROR)
+    {
+      ret = TEST_ERROR;
+      break;
+    }
+  }
+  /* the capacity is full, so this one is remapped */
+  chunk[0] = (int32_t) buf.length;
+  if ((wordbuf_append(&buf, chunk, 1) != MEM_NO_ERROR) || (buf.large != 1))
+  {
+    ret = TEST_ERROR;
+  }
+  else
+  {
+    ret |= resize_check(buf.data, buf.length);
+  }
+  wordbuf_free(&buf);
+#endif
+
+  return ret;
+}
+
+/* Byte (i) of the rotation test pattern, not periodic in 256 */
+static uint8_t rotate_pattern(size_t i)
+{
+  return (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+/* Fills (length) bytes, rotates them by (shift) and checks the result */
+static int8_t rotate_check(uint8_t * buf, size_t length, size_t shift)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    buf[i] = rotate_pattern(i);
+  }
+  if (my_rotate(buf, length, shift) != buf)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < length; i++)
+  {
+    if (buf[i] != rotate_pattern((i + shift) % length))
+    {
+      return TEST_ERROR;
+    }
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_rotate()
+{
+  static const size_t shifts[] =
+  {
+    0, 1, 7, 64, 255, 256, 257, 599, 600, 943, 1199, 1200, 2401
+  };
+  uint8_t * buf;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_rotate()\n");
+  buf = (uint8_t *) reserve_words(ROTATE_TEST_SIZE_B / sizeof(int32_t));
+  if (buf == NULL)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < sizeof(shifts) / sizeof(shifts[0]); i++)
+  {
+    ret |= rotate_check(buf, ROTATE_TEST_SIZE_B, shifts[i]);
+    ret |= rotate_check(buf + 1, ROTATE_TEST_SIZE_B - 3, shifts[i]);
+  }
+  ret |= rotate_check(buf, 0, 5);
+  free_words((int32_t *) buf);
+
+  /* a few MB are more than the MSP432 has */
+#if defined (HOST)
+  buf = (uint8_t *) reserve_words_large(ROTATE_TEST_LARGE_B / sizeof(int32_t) + 1, 0);
+  if (buf == NULL)
+  {
+    return TEST_ERROR;
+  }
+  ret |= rotate_check(buf, ROTATE_TEST_LARGE_B, 300);
+  ret |= rotate_check(buf, ROTATE_TEST_LARGE_B, 4099);
+  ret |= rotate_check(buf, ROTATE_TEST_LARGE_B, ROTATE_TEST_LARGE_B / 2);
+  ret |= rotate_check(buf + 3, ROTATE_TEST_LARGE_B - 3, ROTATE_TEST_LARGE_B / 3);
+  free_words_large((int32_t *) buf);
+#endif
+
+  return ret;
+}
+
+/* Converts (num) with a plain division loop and compares with my_itoa */
+static int8_t itoa_check(int32_t num, uint32_t base)
+{
+  static const uint8_t chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  uint8_t expect[40];
+  uint8_t got[40];
+  uint32_t value = (num < 0) ? 0u - (uint32_t) num : (uint32_t) num;
+  uint8_t length = 0;
+  uint8_t i;
+
+  do
+  {
+    expect[length++] = chars[value % base];
+    value /= base;
+  } while (value != 0);
+  if (num < 0)
+  {
+    expect[length++] = '-';
+  }
+  my_reverse(expect, length);
+  expect[length++] = 0;
+
+  if (my_itoa(num, got, base) != length)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < length; i++)
+  {
+    if (got[i] != expect[i])
+    {
+      return TEST_ERROR;
+    }
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_itoa()
+{
+  uint8_t buf[40];
+  uint32_t base;
+  int64_t power;
+  int64_t num;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_itoa()\n");
+  if ((my_itoa(5, buf, 1) != 0) || (my_itoa(5, buf, DATA_MAX_BASE + 1) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+  for (base = 2; base <= DATA_MAX_BASE; base++)
+  {
+    ret |= itoa_check(0, base);
+    ret |= itoa_check(INT32_MAX, base);
+    ret |= itoa_check(INT32_MIN, base);
+    ret |= itoa_check(INT32_MIN + 1, base);
+    for (power = 1; power <= INT32_MAX; power *= base)
+    {
+      ret |= itoa_check((int32_t) power, base);
+      ret |= itoa_check((int32_t)(power - 1), base);
+      ret |= itoa_check((int32_t)(1 - power), base);
+      ret |= itoa_check((int32_t) -power, base);
+    }
+    for (num = INT32_MIN; num <= INT32_MAX; num += ITOA_TEST_STEP)
+    {
+      ret |= itoa_check((int32_t) num, base);
+    }
+  }
+
+  return ret;
+}
+
+typedef struct
+{
+  const char * text;
+  uint32_t base;
+  int8_t status;
+  int32_t value;
+} atoi_case_t;
+
+/* Runs my_atoi_checked on a C string and compares status and value */
+static int8_t atoi_check(const atoi_case_t * test)
+{
+  uint8_t digits = 1;
+  int32_t value;
+
+  while (test->text[digits - 1] != 0)
+  {
+    digits++;
+  }
+  if ((my_atoi_checked((uint8_t *) test->text, digits, test->base, &value) != test->status) ||
+      (value != test->value))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_atoi()
+{
+  static const atoi_case_t cases[] =
+  {
+    { "0", 10, DATA_OK, 0 },
+    { "-0", 10, DATA_OK, 0 },
+    { "2147483647", 10, DATA_OK, INT32_MAX },
+    { "-2147483648", 10, DATA_OK, INT32_MIN },
+    { "2147483648", 10, DATA_OVERFLOW, INT32_MAX },
+    { "-2147483649", 10, DATA_OVERFLOW, INT32_MIN },
+    { "99999999999999999999", 10, DATA_OVERFLOW, INT32_MAX },
+    { "0000000000000000000123", 10, DATA_OK, 123 },
+    { "-000000000000000002147483648", 10, DATA_OK, INT32_MIN },
+    { "00000000000000010000000000000000", 10, DATA_OVERFLOW, INT32_MAX },
+    { "12345678", 10, DATA_OK, 12345678 },
+    { "1234567890123456789x", 10, DATA_INVALID, 0 },
+    { "12:4", 10, DATA_INVALID, 0 },
+    { "", 10, DATA_INVALID, 0 },
+    { "-", 10, DATA_INVALID, 0 },
+    { "7fffFFFF", 16, DATA_OK, INT32_MAX },
+    { "-80000000", 16, DATA_OK, INT32_MIN },
+    { "80000000", 16, DATA_OVERFLOW, INT32_MAX },
+    { "000000007AbCdEf0", 16, DATA_OK, 0x7ABCDEF0 },
+    { "0000000G", 16, DATA_INVALID, 0 },
+    { "1011", 2, DATA_OK, 11 },
+    { "12", 2, DATA_INVALID, 0 },
+    { "-zz", 10, DATA_INVALID, 0 },
+    { "-zz", 36, DATA_OK, -1295 },
+    { "Zz", 36, DATA_OK, 1295 },
+    { "zik0zj", 36, DATA_OK, INT32_MAX },
+    { "-ZIK0ZK", 36, DATA_OK, INT32_MIN },
+    { "zik0zk", 36, DATA_OVERFLOW, INT32_MAX },
+    { "Z", 35, DATA_INVALID, 0 },
+    { "777", 8, DATA_OK, 511 },
+    { "8", 8, DATA_INVALID, 0 },
+    { "7", DATA_MAX_BASE + 1, DATA_INVALID, 0 },
+  };
+  uint8_t buf[40];
+  uint8_t digits;
+  uint32_t base;
+  int64_t num;
+  int32_t value;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_atoi()\n");
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    ret |= atoi_check(&cases[i]);
+  }
+
+  for (base = 2; base <= DATA_MAX_BASE; base++)
+  {
+    for (num = INT32_MIN; num <= INT32_MAX; num += ITOA_TEST_STEP)
+    {
+      digits = my_itoa((int32_t) num, buf, base);
+      if ((my_atoi_checked(buf, digits, base, &value) != DATA_OK) || (value != (int32_t) num) ||
+          (my_atoi(buf, digits, base) != (int32_t) num))
+      {
+        ret = TEST_ERROR;
+      }
+    }
+  }
+
+  /* a bad character is converted as 0, as my_atoi always did */
+  if ((my_atoi((uint8_t *) "-12:4", 6, 10) != -1204) ||
+      (my_atoi((uint8_t *) "f:", 3, 16) != 0xF0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
+/* Compares my_utoa64 with a plain division loop, then reads it back */
+static int8_t utoa64_check(uint64_t num, uint32_t base)
+{
+  const char * chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  uint8_t expect[70];
+  uint8_t got[70];
+  uint64_t value = num;
+  uint64_t back;
+  uint8_t length = 0;
+  uint8_t i;
+
+  do
+  {
+    expect[length++] = chars[value % base];
+    value /= base;
+  } while (value != 0);
+  my_reverse(expect, length);
+  expect[length++] = 0;
+
+  if (my_utoa64(num, got, base) != length)
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < length; i++)
+  {
+    if (got[i] != expect[i])
+    {
+      return TEST_ERROR;
+    }
+  }
+  if ((my_atou64_checked(got, length, base, &back) != DATA_OK) || (back != num) ||
+      (my_atou64(got, length, base) != num))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+/* The same for my_itoa64 and my_atoi64 */
+static int8_t itoa64_check(int64_t num, uint32_t base)
+{
+  uint8_t got[70];
+  int64_t back;
+  uint8_t length = my_itoa64(num, got, base);
+
+  if (num < 0)
+  {
+    if ((got[0] != '-') || (utoa64_check(0u - (uint64_t) num, base) != TEST_NO_ERROR))
+    {
+      return TEST_ERROR;
+    }
+  }
+  else if (utoa64_check((uint64_t) num, base) != TEST_NO_ERROR)
+  {
+    return TEST_ERROR;
+  }
+  if ((my_atoi64_checked(got, length, base, &back) != DATA_OK) || (back != num) ||
+      (my_atoi64(got, length, base) != num))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+typedef struct
+{
+  const char * text;
+  uint32_t base;
+  int8_t status;
+  int64_t value;
+} atoi64_case_t;
+
+/* Runs my_atoi64_checked on a C string, and my_atou64_checked if the
+ * value is not negative */
+static int8_t atoi64_check(const atoi64_case_t * test)
+{
+  uint8_t digits = 1;
+  int64_t value;
+  uint64_t unsigned_value;
+
+  while (test->text[digits - 1] != 0)
+  {
+    digits++;
+  }
+  if ((my_atoi64_checked((uint8_t *) test->text, digits, test->base, &value) != test->status) ||
+      (value != test->value))
+  {
+    return TEST_ERROR;
+  }
+  if ((test->text[0] != '-') &&
+      ((my_atou64_checked((uint8_t *) test->text, digits, test->base, &unsigned_value) != test->status) ||
+       ((test->status != DATA_OVERFLOW) && (unsigned_value != (uint64_t) test->value))))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_int64()
+{
+  static const atoi64_case_t cases[] =
+  {
+    { "9223372036854775807", 10, DATA_OK, INT64_MAX },
+    { "-9223372036854775808", 10, DATA_OK, INT64_MIN },
+    { "-9223372036854775809", 10, DATA_OVERFLOW, INT64_MIN },
+    { "000000000000000000000009223372036854775807", 10, DATA_OK, INT64_MAX },
+    { "123456789012345678901234567890", 10, DATA_OVERFLOW, INT64_MAX },
+    { "1234567890123456", 10, DATA_OK, 1234567890123456LL },
+    { "12345678901234567", 10, DATA_OK, 12345678901234567LL },
+    { "7FFFffffFFFFffff", 16, DATA_OK, INT64_MAX },
+    { "-8000000000000000", 16, DATA_OK, INT64_MIN },
+    { "zzzzzzzzzzzz", 36, DATA_OK, 4738381338321616895LL },
+    { "1y2p0ij32e8e7", 36, DATA_OK, INT64_MAX },
+    { "12345678901234567x", 10, DATA_INVALID, 0 },
+    { "-", 10, DATA_INVALID, 0 },
+  };
+  static const uint64_t edges[] =
+  {
+    0, 1, 99999999ULL, 100000000ULL, 4294967295ULL, 4294967296ULL,
+    9999999999999999ULL, 10000000000000000ULL, 429496729599999999ULL,
+    429496729600000000ULL, 10000000000000000000ULL, UINT64_MAX - 1, UINT64_MAX
+  };
+  uint8_t buf[70];
+  uint64_t value;
+  uint64_t power;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  uint32_t base;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_int64()\n");
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    ret |= atoi64_check(&cases[i]);
+  }
+  /* past 64 bits, and a sign, for the unsigned conversions */
+  if ((my_atou64_checked((uint8_t *) "18446744073709551615", 21, 10, &value) != DATA_OK) || (value != UINT64_MAX) ||
+      (my_atou64_checked((uint8_t *) "18446744073709551616", 21, 10, &value) != DATA_OVERFLOW) || (value != UINT64_MAX) ||
+      (my_atou64_checked((uint8_t *) "10000000000000000", 18, 16, &value) != DATA_OVERFLOW) ||
+      (my_atou64_checked((uint8_t *) "-1", 3, 10, &value) != DATA_INVALID) || (value != 0) ||
+      (my_atou64((uint8_t *) "f:", 3, 16) != 0xF0) ||
+      (my_itoa64(5, buf, 1) != 0) || (my_utoa64(5, buf, DATA_MAX_BASE + 1) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (base = 2; base <= DATA_MAX_BASE; base++)
+  {
+    for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+    {
+      ret |= utoa64_check(edges[i], base);
+    }
+    ret |= itoa64_check(INT64_MAX, base);
+    ret |= itoa64_check(INT64_MIN, base);
+    ret |= itoa64_check(INT64_MIN + 1, base);
+    /* powers of the base and their neighbours cross every chunk border */
+    for (power = base; power <= UINT64_MAX / base; power *= base)
+    {
+      ret |= utoa64_check(power, base);
+      ret |= utoa64_check(power - 1, base);
+      if (power <= INT64_MAX)
+      {
+        ret |= itoa64_check(-(int64_t) power, base);
+      }
+    }
+    for (i = 0; i < INT64_TEST_VALUES; i++)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      value = seed >> (seed & 63); // every magnitude
+      ret |= utoa64_check(value, base);
+      ret |= itoa64_check((int64_t) seed, base);
+    }
+  }
+
+  return ret;
+}
+
+int8_t test_itoa_batch()
+{
+  static const uint32_t bases[] = { 2, 7, 10, 16, 36 };
+  static const size_t sizes[] = { 34, 35, 61, 1000, BATCH_TEST_TEXT_B };
+  static int32_t values[BATCH_TEST_VALUES];
+  static uint8_t expect[BATCH_TEST_TEXT_B];
+  static uint8_t got[BATCH_TEST_TEXT_B];
+  static uint8_t chunk[BATCH_TEST_TEXT_B + 1];
+  uint32_t magnitude;
+  uint32_t seed = 12345;
+  size_t expect_length;
+  size_t got_length;
+  size_t index;
+  size_t written;
+  size_t b;
+  size_t s;
+  size_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  PRINTF("test_itoa_batch()\n");
+  values[0] = INT32_MIN;
+  values[1] = 0;
+  values[2] = INT32_MAX;
+  for (i = 3; i < BATCH_TEST_VALUES; i++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    magnitude = seed >> (seed & 31); // every length
+    values[i] = (int32_t)((seed & 64) ? 0u - magnitude : magnitude);
+  }
+
+  for (b = 0; b < sizeof(bases) / sizeof(bases[0]); b++)
+  {
+    /* the same text from my_itoa, without the terminators */
+    expect_length = 0;
+    for (i = 0; i < BATCH_TEST_VALUES; i++)
+    {
+      if (i != 0)
+      {
+        expect[expect_length++] = ',';
+      }
+      expect_length += my_itoa(values[i], expect + expect_length, bases[b]) - 1;
+    }
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      index = 0;
+      got_length = 0;
+      while (index < BATCH_TEST_VALUES)
+      {
+        chunk[sizes[s]] = 0xA5;
+        written = my_itoa_batch(values, BATCH_TEST_VALUES, &index, bases[b], ',', chunk, sizes[s]);
+        /* a value that does not fit is left whole for the next buffer */
+        if ((written == 0) || (written > sizes[s]) || (chunk[sizes[s]] != 0xA5) ||
+            ((index < BATCH_TEST_VALUES) && (written + BATCH_TEST_MAX_B <= sizes[s])))
+        {
+          return TEST_ERROR;
+        }
+        my_memcopy(chunk, got + got_length, written);
+        got_length += written;
+      }
+      if ((got_length != expect_length) || (my_memcmp(got, expect, got_length) != 0))
+      {
+        ret = TEST_ERROR;
+      }
+    }
+  }
+
+  /* too small for the first value, and a base that is not supported */
+  index = 0;
+  if ((my_itoa_batch(values, BATCH_TEST_VALUES, &index, 10, ',', chunk, 5) != 0) || (index != 0) ||
+      (my_itoa_batch(values, BATCH_TEST_VALUES, &index, 37, ',', chunk, 100) != 0) || (index != 0) ||
+      (my_itoa_batch(values + 1, 1, &index, 10, ',', chunk, 1) != 1) || (index != 1) || (chunk[0] != '0'))
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
 void course1(void) 
 {
   uint8_t i;
@@ -357,6 +2173,29 @@ void course1(void)
   results[5] = test_memcopy();
   results[6] = test_memset();
   results[7] = test_reverse();
+  results[8] = test_memcopy_align();
+  results[9] = test_memmove_overlap();
+  results[10] = test_memset_align();
+  results[11] = test_reverse_lengths();
+  results[12] = test_arena();
+  results[13] = test_pool();
+  results[14] = test_words_threads();
+  results[15] = test_instrument();
+  results[16] = test_memmove_sg();
+  results[17] = test_async_copy();
+  results[18] = test_memory_parallel();
+  results[19] = test_memcmp_search();
+  results[20] = test_memcopy_checksum();
+  results[21] = test_bswap();
+  results[22] = test_ring_buffer();
+  results[23] = test_slices();
+  results[24] = test_reserve_aligned();
+  results[25] = test_resize_words();
+  results[26] = test_rotate();
+  results[27] = test_itoa();
+  results[28] = test_atoi();
+  results[29] = test_int64();
+  results[30] = test_itoa_batch();
 
   for ( i = 0; i < TESTCOUNT; i++) 
   {
@@ -17,32 +17,108 @@
  */
 
 #include "data.h"
-#include <math.h>
 
-uint32_t get_max_digit_position(int32_t data, uint32_t base)
+/* -DMEMORY_NO_SIMD builds the portable parser of the MSP432 build on the host */
+#if defined (HOST) && (defined (__x86_64__) || defined (__i386__)) && !defined (MEMORY_NO_SIMD)
+  #define DATA_X86_SIMD
+  #include <immintrin.h>
+#endif
+
+/* Lowest digit count of a number with (32 - i) significant bits, indexed
+ * by the count of leading zeros */
+static const uint8_t clz_digits[32] =
+{
+    10, 10, 9, 9, 9, 8, 8, 8, 7, 7, 7, 7, 6, 6, 6, 5,
+    5, 5, 4, 4, 4, 4, 3, 3, 3, 2, 2, 2, 1, 1, 1, 1
+};
+
+/* dec_powers[i] = 10^i; a number with clz_digits[] digits has one more
+ * if it reaches the next power */
+static const uint32_t dec_powers[10] =
+{
+    1u, 10u, 100u, 1000u, 10000u, 100000u,
+    1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+/* "00" to "99": base 10 is written two digits per division */
+static const uint8_t digit_pairs[200] =
+{
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+/* Alphabet of bases up to 36: digit i is digit_chars[i] */
+static const uint8_t digit_chars[DATA_MAX_BASE] =
+{
+    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F','G','H',
+    'I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z'
+};
+
+#define ND (0xFF) // no digit
+
+/* Value of every character as a digit, upper and lower case letters alike,
+ * ND for characters that are no digit in any base */
+static const uint8_t digit_values[256] =
 {
-    /* 
-    base ^ x = data
-    log(base^x)=log(data)
-    x*log(base)=log(data)
-    x=log(data)/log(base)
-    Then we round the result to the closest higher int
-    */
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, ND, ND, ND, ND, ND, ND,
+    ND, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, ND, ND, ND, ND, ND,
+    ND, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND,
+    ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND, ND
+};
 
-   /* handle incorrect arguments */
-   if ((data == 0) || (base == 0) || (base == 1)) {return 0;}
+/* Number of significant bits of (value), at least 1 */
+static uint32_t bit_length(uint32_t value)
+{
+    return 32 - __builtin_clz(value | 1); // CLZ instruction on the Cortex-M4
+}
+
+/* The same for 64 bits, two CLZ on the Cortex-M4 */
+static uint32_t bit_length64(uint64_t value)
+{
+    return 64 - __builtin_clzll(value | 1);
+}
 
-   return (uint32_t) round( log((double) data) / log((double)base) );
+/* Number of decimal digits of (value): a table guess from the leading
+ * zeros, corrected by one compare */
+static uint32_t dec_length(uint32_t value)
+{
+    uint32_t digits = *(clz_digits + __builtin_clz(value | 1));
+
+    if ((digits < 10) && (value >= *(dec_powers + digits)))
+    {
+        digits++;
+    }
+    return digits;
 }
 
-/** Converts digit [0 -9] to a character ['0' - '9']
+/** Converts digit [0 - 35] to a character ['0' - '9', 'A' - 'Z']
  * In case of wrong digit returns 0 (null terminator)
  **/
 uint8_t digit_to_ch(uint8_t curr_digit)
 {
-    if (curr_digit < 10) // for 0,1,2,3.., 9
+    if (curr_digit < DATA_MAX_BASE)
     {
-        return (curr_digit + 48); //ASCII value of digits [0 – 9] ranges from [48 – 57]
+        return *(digit_chars + curr_digit);
     }
     else
     {
@@ -50,110 +126,844 @@ uint8_t digit_to_ch(uint8_t curr_digit)
     }
 }
 
+/* Writes the (length) decimal digits of (value) so they end at (end) */
+static void utoa_dec(uint32_t value, uint8_t * end, uint32_t length)
+{
+    const uint8_t * pair;
+
+    while (value >= 100)
+    {
+        pair = digit_pairs + (value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        *end = *pair;
+        *(end + 1) = *(pair + 1);
+    }
+    if (length & 1)
+    {
+        *(end - 1) = (uint8_t)('0' + value);
+    }
+    else
+    {
+        pair = digit_pairs + value * 2;
+        *(end - 2) = *pair;
+        *(end - 1) = *(pair + 1);
+    }
+}
+
+/* Writes the digits of (value) in base 2^(shift) so they end at (end) */
+static void utoa_pow2(uint32_t value, uint8_t * end, uint32_t shift)
+{
+    uint32_t mask = (1u << shift) - 1;
+
+    do
+    {
+        end--;
+        *end = *(digit_chars + (value & mask));
+        value >>= shift;
+    } while (value != 0);
+}
+
+/* Defines name(value, ptr) for a power of two base, which writes the
+ * digits of (value) at (ptr) and returns their number. The base is a
+ * constant in each copy, so the compiler turns the shifts and masks into
+ * immediates; (type) and (bits) give the 32 and 64 bit copies. */
+#define DATA_UTOA_POW2(name, type, bits, base, shift)                     \
+static uint32_t name(type value, uint8_t * ptr)                           \
+{                                                                         \
+    uint32_t length = (bits(value) + (shift) - 1) / (shift);              \
+    uint8_t * end = ptr + length;                                         \
+                                                                          \
+    do                                                                    \
+    {                                                                     \
+        end--;                                                            \
+        *end = *(digit_chars + (value & ((base) - 1)));                   \
+        value >>= (shift);                                                \
+    } while (value != 0);                                                 \
+    return length;                                                        \
+}
+
+DATA_UTOA_POW2(utoa_base2, uint32_t, bit_length, 2, 1)
+DATA_UTOA_POW2(utoa_base8, uint32_t, bit_length, 8, 3)
+DATA_UTOA_POW2(utoa_base16, uint32_t, bit_length, 16, 4)
+DATA_UTOA_POW2(utoa64_base2, uint64_t, bit_length64, 2, 1)
+DATA_UTOA_POW2(utoa64_base8, uint64_t, bit_length64, 8, 3)
+DATA_UTOA_POW2(utoa64_base16, uint64_t, bit_length64, 16, 4)
+
+static uint32_t utoa_base10(uint32_t value, uint8_t * ptr)
+{
+    uint32_t length = dec_length(value);
+
+    utoa_dec(value, ptr + length, length);
+    return length;
+}
+
+/* Writes the digits of (value) in any other base so they end at (end) */
+static void utoa_generic(uint32_t value, uint8_t * end, uint32_t base)
+{
+    do
+    {
+        end--;
+        *end = *(digit_chars + value % base);
+        value /= base;
+    } while (value != 0);
+}
+
+/* Number of digits of (value) in a base that is not a power of two */
+static uint32_t generic_length(uint32_t value, uint32_t base)
+{
+    uint32_t digits = 1;
+
+    while (value >= base)
+    {
+        value /= base;
+        digits++;
+    }
+    return digits;
+}
+
+/* Digits of (value) at (ptr), returns their number */
+static uint32_t utoa_digits(uint32_t value, uint8_t * ptr, uint32_t base)
+{
+    uint32_t shift; // log2(base) for a power of two base
+    uint32_t length;
+
+    switch (base)
+    {
+        case 2:  return utoa_base2(value, ptr);
+        case 8:  return utoa_base8(value, ptr);
+        case 10: return utoa_base10(value, ptr);
+        case 16: return utoa_base16(value, ptr);
+        default:
+            if ((base & (base - 1)) == 0)
+            {
+                shift = __builtin_ctz(base);
+                length = (bit_length(value) + shift - 1) / shift;
+                utoa_pow2(value, ptr + length, shift);
+            }
+            else
+            {
+                length = generic_length(value, base);
+                utoa_generic(value, ptr + length, base);
+            }
+            return length;
+    }
+}
+
+/* Number of digits utoa_digits writes for (value) */
+static uint32_t utoa_length(uint32_t value, uint32_t base)
+{
+    uint32_t shift;
+
+    if (base == 10)
+    {
+        return dec_length(value);
+    }
+    if ((base & (base - 1)) == 0)
+    {
+        shift = __builtin_ctz(base);
+        return (bit_length(value) + shift - 1) / shift;
+    }
+    return generic_length(value, base);
+}
+
 /**
  * @brief Convert data from a standard integer type into an ASCII string
  *
+ * Integer arithmetic only: the digit count is known before any digit is
+ * written, so the digits are written from the end without a reversal.
+ * Bases 2, 8, 10 and 16 have converters of their own; base 10 takes two
+ * digits per division from a table, the others shifts and masks.
+ *
  * @param int32_t data - number to convert
  * @param uint8_t * ptr - pointer where we can save resulting string 
- * @param uint32_t base - number base from2 to 16
+ * @param uint32_t base - number base from 2 to 36
  * 
  * @return uint8_t - number of characters in the resulting sting, including end \0
  */
 uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base) 
 {
-    uint8_t curr_digit; //digit on a current position
-    int32_t base_pow_i; //base ^i
+    uint32_t value; // magnitude, also of INT32_MIN
+    uint32_t length; // number of digits
     uint8_t ch_num = 0; //number fo characters written to a string
-    uint8_t i; // position of a current digit
+
+    if ((base < 2) || (base > DATA_MAX_BASE)) {return 0;} //unsuported situation, base should be [2;36]
 
     if (data < 0)
     {
         *ptr = '-';
         ptr++;
         ch_num ++;
-    }
-    data = abs(data);
-    
-    // log of 0 is undefined
-    if (base < 2) {return 0;} //unsuported situation, base should be [2;16]
-    if (data == 0 ) 
-    { 
-        i = 0; 
+        value = 0u - (uint32_t) data;
     }
     else
     {
-        i = get_max_digit_position(data, base);// i = max position of a digit
+        value = (uint32_t) data;
     }
-    
 
-    /* Handle the situation of leading zeroes -
-    when get_max_digit_position() returns bigger position then required,
-    we should just skip them */
-    while (i > 0)
+    length = utoa_digits(value, ptr, base);
+
+    *(ptr + length) = 0;
+    ch_num += length + 1;
+
+    return ch_num;
+}
+
+/* Writes exactly (length) digits of (value) in (base), with leading
+ * zeros, so they end at (end). Used for the low chunks of 64 bit values. */
+static void utoa_padded(uint32_t value, uint8_t * end, uint32_t base, uint32_t length)
+{
+    const uint8_t * pair;
+
+    if (base == 10)
     {
-        base_pow_i = (int32_t) pow ((double)base,(double)i); // base^i
-        curr_digit = data / base_pow_i;
-        
-        if (curr_digit != 0) { break;}
-        i--;
+        for (; length >= 2; length -= 2)
+        {
+            pair = digit_pairs + (value % 100) * 2;
+            value /= 100;
+            end -= 2;
+            *end = *pair;
+            *(end + 1) = *(pair + 1);
+        }
+        if (length != 0)
+        {
+            *(end - 1) = (uint8_t)('0' + value);
+        }
+        return;
     }
-    
-    /* Here we should not skip zeroes, because they are not leading */
-    /* Before this loop i is pointing to the first(!) non-zero digit */
-    while( i >  0)
+    for (; length != 0; length--)
     {
-        base_pow_i = (int32_t) pow ((double)base,(double)i); // base^i
-        curr_digit = data / base_pow_i;
-        
-        *ptr = digit_to_ch(curr_digit);
-        ptr++;
-        ch_num ++;
+        end--;
+        *end = *(digit_chars + value % base);
+        value /= base;
+    }
+}
 
-        i --;
-        data = data % base_pow_i;
+/* Largest power of (base) that fits 32 bits, and its exponent in (digits) */
+static uint32_t chunk_divisor(uint32_t base, uint32_t * digits)
+{
+    uint32_t divisor = base;
+
+    *digits = 1;
+    while (divisor <= UINT32_MAX / base)
+    {
+        divisor *= base;
+        (*digits)++;
     }
- 
+    return divisor;
+}
+
+/* Digits of a 32 bit (value) in a base that is not a power of two */
+static uint32_t utoa_chunk(uint32_t value, uint8_t * ptr, uint32_t base)
+{
+    uint32_t length = (base == 10) ? dec_length(value) : generic_length(value, base);
 
-    /* for  i == 0; base_pow_i == 1;  curr_digit == data; */
-    *ptr = digit_to_ch(data);
-    ptr++;
-    ch_num ++;
+    utoa_padded(value, ptr + length, base, length);
+    return length;
+}
 
-    *ptr = 0;
-    ch_num ++;
+/* Digits of a 64 bit (value) in a base that is not a power of two. The
+ * value is cut into chunks of 32 bits with at most two 64 bit divisions,
+ * which the Cortex-M4 has to do in software, and the chunks are written
+ * with 32 bit divisions, which it has in hardware. */
+static uint32_t utoa64_chunked(uint64_t value, uint8_t * ptr, uint32_t base)
+{
+    uint32_t digits = 8; // digits per chunk, base 10 keeps whole pairs
+    uint32_t divisor = 100000000u;
+    uint64_t high;
+    uint32_t top;
+    uint32_t length;
 
-    return ch_num;
+    if (value <= UINT32_MAX)
+    {
+        return utoa_chunk((uint32_t) value, ptr, base);
+    }
+    if (base != 10)
+    {
+        divisor = chunk_divisor(base, &digits);
+    }
+
+    high = value / divisor;
+    if (high <= UINT32_MAX)
+    {
+        length = utoa_chunk((uint32_t) high, ptr, base);
+    }
+    else
+    {
+        // divisor > 2^32 / 36, so what is left above two chunks fits 32 bits
+        top = (uint32_t)(high / divisor);
+        length = utoa_chunk(top, ptr, base);
+        length += digits;
+        utoa_padded((uint32_t)(high - (uint64_t) top * divisor), ptr + length, base, digits);
+    }
+    length += digits;
+    utoa_padded((uint32_t)(value - high * divisor), ptr + length, base, digits);
+    return length;
+}
+
+/* Digits of a 64 bit (value) at (ptr), returns their number */
+static uint32_t utoa64_digits(uint64_t value, uint8_t * ptr, uint32_t base)
+{
+    uint32_t shift;
+    uint32_t length;
+    uint8_t * end;
+
+    switch (base)
+    {
+        case 2:  return utoa64_base2(value, ptr);
+        case 8:  return utoa64_base8(value, ptr);
+        case 16: return utoa64_base16(value, ptr);
+        default:
+            if ((base & (base - 1)) != 0)
+            {
+                return utoa64_chunked(value, ptr, base);
+            }
+            shift = __builtin_ctz(base);
+            length = (bit_length64(value) + shift - 1) / shift;
+            end = ptr + length;
+            do
+            {
+                end--;
+                *end = *(digit_chars + (value & (base - 1)));
+                value >>= shift;
+            } while (value != 0);
+            return length;
+    }
+}
+
+/**
+ * @brief Convert an unsigned 64 bit number into an ASCII string
+ *
+ * Powers of two are written with 64 bit shifts. Other bases cut the
+ * value into 32 bit chunks first, see utoa64_chunked.
+ *
+ * @param uint64_t data - number to convert
+ * @param uint8_t * ptr - pointer where we can save resulting string, at least 65 bytes
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint8_t - number of characters in the resulting sting, including end \0
+ */
+uint8_t my_utoa64(uint64_t data, uint8_t * ptr, uint32_t base)
+{
+    uint32_t length;
+
+    if ((base < 2) || (base > DATA_MAX_BASE)) {return 0;} //unsuported situation, base should be [2;36]
+
+    length = utoa64_digits(data, ptr, base);
+    *(ptr + length) = 0;
+    return (uint8_t)(length + 1);
+}
+
+/**
+ * @brief Convert a signed 64 bit number into an ASCII string
+ *
+ * @param int64_t data - number to convert
+ * @param uint8_t * ptr - pointer where we can save resulting string, at least 66 bytes
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint8_t - number of characters in the resulting sting, including end \0
+ */
+uint8_t my_itoa64(int64_t data, uint8_t * ptr, uint32_t base)
+{
+    if ((base < 2) || (base > DATA_MAX_BASE)) {return 0;} //unsuported situation, base should be [2;36]
+
+    if (data < 0)
+    {
+        *ptr = '-';
+        return (uint8_t)(my_utoa64(0u - (uint64_t) data, ptr + 1, base) + 1); // magnitude, also of INT64_MIN
+    }
+    return my_utoa64((uint64_t) data, ptr, base);
+}
+
+/* Most a value can take in my_itoa_batch: delimiter, '-' and 32 binary digits */
+#define ITOA_BATCH_MAX_B (34)
+
+/**
+ * @brief Writes an array of numbers as delimited text into one buffer
+ *
+ * The digits go straight into (out). Only the last few values before the
+ * end of the buffer have their length computed first, to see if they fit.
+ *
+ * @param const int32_t * values - numbers to convert
+ * @param size_t count - number of values
+ * @param size_t * index - first value to write, set to the first value not written
+ * @param uint32_t base - number base from 2 to 36
+ * @param uint8_t delimiter - character written before every value but the first of the array
+ * @param uint8_t * out - where to write the text, it is not null terminated
+ * @param size_t out_length - size of (out) in bytes
+ *
+ * @return size_t - number of bytes written
+ */
+size_t my_itoa_batch(const int32_t * values, size_t count, size_t * index, uint32_t base,
+                     uint8_t delimiter, uint8_t * out, size_t out_length)
+{
+    uint8_t * pos = out;
+    uint8_t * end = out + out_length;
+    size_t i = *index;
+    int32_t data;
+    uint32_t value; // magnitude, also of INT32_MIN
+    uint32_t needed;
+
+    if ((base < 2) || (base > DATA_MAX_BASE)) {return 0;} //unsuported situation, base should be [2;36]
+
+    for (; i < count; i++)
+    {
+        data = *(values + i);
+        value = (data < 0) ? 0u - (uint32_t) data : (uint32_t) data;
+        if ((size_t)(end - pos) < ITOA_BATCH_MAX_B)
+        {
+            // near the end: a value is written whole or not at all
+            needed = (i != 0) + (data < 0) + utoa_length(value, base);
+            if ((size_t)(end - pos) < needed)
+            {
+                break;
+            }
+        }
+        if (i != 0)
+        {
+            *pos = delimiter;
+            pos++;
+        }
+        if (data < 0)
+        {
+            *pos = '-';
+            pos++;
+        }
+        pos += utoa_digits(value, pos, base);
+    }
+
+    *index = i;
+    return (size_t)(pos - out);
 }
 
-/** Converts character ['0' - '9'] to a digit [0 -9]
+/** Converts character ['0' - '9', 'A' - 'Z', 'a' - 'z'] to a digit [0 - 35]
  * In case of wrong character returns 0 
  **/
 uint8_t ch_to_digit (uint8_t ch)
 {
-    if ( (ch >= 48) && (ch <= 57)) // for '0','1','2'.., '9'
+    uint8_t digit = *(digit_values + ch);
+
+    return (digit == ND) ? 0 : digit; //all incorrect characters are treated as 0
+}
+
+/* Unaligned view of 8 characters. Both platforms are little endian, so
+ * the first character lands in the lowest byte. */
+typedef struct { uint64_t v; } __attribute__((__packed__, __may_alias__)) data_u64_t;
+
+#define SWAR_ONES  (0x0101010101010101ULL)
+#define SWAR_HIGHS (0x8080808080808080ULL)
+
+/* Bytes of (x) strictly between (m) and (n), for bytes below 0x80: the
+ * high bit of every such byte is set */
+#define SWAR_BETWEEN(x, m, n) \
+    (((SWAR_ONES * (127 + (n)) - ((x) & (SWAR_ONES * 127))) & ~(x) & \
+      (((x) & (SWAR_ONES * 127)) + SWAR_ONES * (127 - (m)))) & SWAR_HIGHS)
+
+/* 1 if all 8 characters of (chars) are '0' - '9' */
+static uint8_t swar_is_dec8(uint64_t chars)
+{
+    return ((chars & SWAR_HIGHS) == 0) && (SWAR_BETWEEN(chars, '0' - 1, '9' + 1) == SWAR_HIGHS);
+}
+
+/* Value of 8 decimal characters: pairs, then groups of 4, then all 8
+ * are combined with one multiply-add each */
+static uint32_t swar_dec8(uint64_t chars)
+{
+    chars -= SWAR_ONES * '0';
+    chars = (chars * 10) + (chars >> 8);
+    chars = (((chars & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chars >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t) chars;
+}
+
+/* 1 if all 8 characters of (chars) are '0' - '9', 'A' - 'F' or 'a' - 'f' */
+static uint8_t swar_is_hex8(uint64_t chars)
+{
+    uint64_t lower = chars | (SWAR_ONES * 0x20); // letters to lower case, digits stay
+
+    return ((chars & SWAR_HIGHS) == 0) &&
+           ((SWAR_BETWEEN(chars, '0' - 1, '9' + 1) | SWAR_BETWEEN(lower, 'a' - 1, 'f' + 1)) == SWAR_HIGHS);
+}
+
+/* Value of 8 hex characters: the low nibble, plus 9 for letters (bit 6),
+ * then the nibbles are packed pairwise */
+static uint32_t swar_hex8(uint64_t chars)
+{
+    chars = (chars & (SWAR_ONES * 0x0F)) + ((chars >> 6) & SWAR_ONES) * 9;
+    chars = ((chars << 4) | (chars >> 8)) & 0x00FF00FF00FF00FFULL;
+    chars = ((chars << 8) | (chars >> 16)) & 0x0000FFFF0000FFFFULL;
+    chars = ((chars << 16) | (chars >> 32)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t) chars;
+}
+
+/* Value of 16 decimal characters, or 0 if one is not a digit */
+static uint8_t parse16_swar(const uint8_t * src, uint64_t * value)
+{
+    uint64_t high = ((const data_u64_t *) src)->v;
+    uint64_t low = ((const data_u64_t *) (src + 8))->v;
+
+    if (!swar_is_dec8(high) || !swar_is_dec8(low))
     {
-        return (ch - 48); //ASCII value of digits [0 – 9] ranges from [48 – 57]
+        return 0;
     }
-    else
+    *value = (uint64_t) swar_dec8(high) * 100000000u + swar_dec8(low);
+    return 1;
+}
+
+#ifdef DATA_X86_SIMD
+/* The same with one vector: digits are checked with an unsigned minimum,
+ * then pairs, groups of 4 and of 8 are built with multiply-adds */
+__attribute__((target("ssse3")))
+static uint8_t parse16_ssse3(const uint8_t * src, uint64_t * value)
+{
+    __m128i digits = _mm_sub_epi8(_mm_loadu_si128((const __m128i *) src), _mm_set1_epi8('0'));
+    __m128i valid = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    __m128i pairs;
+    __m128i quads;
+    __m128i octets;
+
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+    {
+        return 0;
+    }
+    pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                    10, 1, 10, 1, 10, 1, 10, 1));
+    quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    quads = _mm_packs_epi32(quads, quads); // at most 9999, fits 16 bits
+    octets = _mm_madd_epi16(quads, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    *value = (uint64_t)(uint32_t) _mm_cvtsi128_si32(octets) * 100000000u +
+             (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(octets, 4));
+    return 1;
+}
+
+typedef uint8_t (*parse16_kernel_t)(const uint8_t * src, uint64_t * value);
+
+static uint8_t parse16_resolve(const uint8_t * src, uint64_t * value);
+
+/* Selected 16 digit kernel. Starts at the resolver, which replaces itself
+ * with the best kernel for this CPU on the first call. */
+static parse16_kernel_t parse16_kernel = parse16_resolve;
+
+static void data_select_kernels(void)
+{
+    __builtin_cpu_init();
+    parse16_kernel = __builtin_cpu_supports("ssse3") ? parse16_ssse3 : parse16_swar;
+}
+
+static uint8_t parse16_resolve(const uint8_t * src, uint64_t * value)
+{
+    data_select_kernels();
+    return parse16_kernel(src, value);
+}
+
+/* Select before main, so threads never race on the first call */
+__attribute__((constructor))
+static void data_init_kernels(void)
+{
+    data_select_kernels();
+}
+
+  #define PARSE16(src, value) parse16_kernel((src), (value))
+#else
+  #define PARSE16(src, value) parse16_swar((src), (value))
+#endif
+
+/* 1 if (acc * mul + add) passes (limit), else that value goes to (acc).
+ * The checks hold for any limit up to UINT64_MAX, so the 32 and 64 bit
+ * conversions share the parsers. */
+static uint8_t acc_push(uint64_t * acc, uint64_t mul, uint64_t add, uint64_t limit)
+{
+    uint64_t next;
+
+    if (__builtin_mul_overflow(*acc, mul, &next) ||
+        __builtin_add_overflow(next, add, &next) || (next > limit))
+    {
+        return 1;
+    }
+    *acc = next;
+    return 0;
+}
+
+/* Parses (length) decimal characters. Every character is checked even
+ * after the value passed (limit), so a bad character wins over overflow. */
+static int8_t parse_base10(const uint8_t * ptr, size_t length, uint64_t limit, uint64_t * value)
+{
+    uint64_t acc = 0;
+    uint64_t block;
+    uint64_t chars;
+    uint8_t over = 0;
+    uint8_t digit;
+
+    while (length >= 16)
+    {
+        if (!PARSE16(ptr, &block))
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, 10000000000000000ULL, block, limit);
+        }
+        ptr += 16;
+        length -= 16;
+    }
+    while (length >= 8)
+    {
+        chars = ((const data_u64_t *) ptr)->v;
+        if (!swar_is_dec8(chars))
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, 100000000u, swar_dec8(chars), limit);
+        }
+        ptr += 8;
+        length -= 8;
+    }
+    while (length != 0)
+    {
+        digit = *ptr - '0';
+        if (digit > 9)
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, 10, digit, limit);
+        }
+        ptr++;
+        length--;
+    }
+
+    *value = acc;
+    return over ? DATA_OVERFLOW : DATA_OK;
+}
+
+/* Parses (length) hex characters, upper or lower case */
+static int8_t parse_base16(const uint8_t * ptr, size_t length, uint64_t limit, uint64_t * value)
+{
+    uint64_t acc = 0;
+    uint64_t chars;
+    uint8_t over = 0;
+    uint8_t digit;
+
+    while (length >= 8)
+    {
+        chars = ((const data_u64_t *) ptr)->v;
+        if (!swar_is_hex8(chars))
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, 1ULL << 32, swar_hex8(chars), limit);
+        }
+        ptr += 8;
+        length -= 8;
+    }
+    while (length != 0)
+    {
+        digit = *(digit_values + *ptr);
+        if (digit > 15)
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, 16, digit, limit);
+        }
+        ptr++;
+        length--;
+    }
+
+    *value = acc;
+    return over ? DATA_OVERFLOW : DATA_OK;
+}
+
+/* Defines parse_base<base>(ptr, length, limit, value) for a power of two
+ * base, with the base a constant in each copy */
+#define DATA_PARSE_POW2(base)                                             \
+static int8_t parse_base##base(const uint8_t * ptr, size_t length,        \
+                               uint64_t limit, uint64_t * value)          \
+{                                                                         \
+    uint64_t acc = 0;                                                     \
+    uint8_t over = 0;                                                     \
+    uint8_t digit;                                                        \
+                                                                          \
+    while (length != 0)                                                   \
+    {                                                                     \
+        digit = *(digit_values + *ptr);                                   \
+        if (digit >= (base))                                              \
+        {                                                                 \
+            return DATA_INVALID;                                          \
+        }                                                                 \
+        if (!over)                                                        \
+        {                                                                 \
+            over = acc_push(&acc, (base), digit, limit);                  \
+        }                                                                 \
+        ptr++;                                                            \
+        length--;                                                         \
+    }                                                                     \
+                                                                          \
+    *value = acc;                                                         \
+    return over ? DATA_OVERFLOW : DATA_OK;                                \
+}
+
+DATA_PARSE_POW2(2)
+DATA_PARSE_POW2(8)
+
+/* Parses (length) characters in any other base up to 36 */
+static int8_t parse_generic(const uint8_t * ptr, size_t length, uint32_t base,
+                            uint64_t limit, uint64_t * value)
+{
+    uint64_t acc = 0;
+    uint8_t over = 0;
+    uint8_t digit;
+
+    while (length != 0)
     {
-        return 0; //all incorrect characters are treated as 0
+        digit = *(digit_values + *ptr);
+        if (digit >= base)
+        {
+            return DATA_INVALID;
+        }
+        if (!over)
+        {
+            over = acc_push(&acc, base, digit, limit);
+        }
+        ptr++;
+        length--;
+    }
+
+    *value = acc;
+    return over ? DATA_OVERFLOW : DATA_OK;
+}
+
+/* Reads the sign when (is_signed), checks base and length and parses the
+ * digits. (limit) is the largest positive magnitude, a negative one may be
+ * one more. Sets (negative) and the magnitude in (value). */
+static int8_t parse_number(uint8_t * ptr, uint8_t digits, uint32_t base, uint64_t limit,
+                           uint8_t is_signed, uint8_t * negative, uint64_t * value)
+{
+    *negative = 0;
+    *value = 0;
+    if ((base < 2) || (base > DATA_MAX_BASE)) {return DATA_INVALID;}
+
+    if (is_signed && (digits != 0) && (*ptr == '-'))
+    {
+        *negative = 1;
+        limit++;
+        ptr++;
+        digits--;
+    }
+    /* at least one digit and the terminator */
+    if (digits < 2) {return DATA_INVALID;}
+    digits--;
+
+    switch (base)
+    {
+        case 2:  return parse_base2(ptr, digits, limit, value);
+        case 8:  return parse_base8(ptr, digits, limit, value);
+        case 10: return parse_base10(ptr, digits, limit, value);
+        case 16: return parse_base16(ptr, digits, limit, value);
+        default: return parse_generic(ptr, digits, base, limit, value);
     }
 }
 
 /**
- * @brief  Converts data back from an ASCII represented string into an 
- * integer type.
+ * @brief Converts an ASCII string into an integer and checks it
  *
  * @param uint8_t * ptr - pointer to a number in a form of string to convert
  * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
- * @param uint32_t base - number base from 2 to 16
- * 
- * @return int32_t - converted number
+ * @param uint32_t base - number base from 2 to 36
+ * @param int32_t * result - where to save the converted number
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
  **/
-int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base) 
+int8_t my_atoi_checked(uint8_t * ptr, uint8_t digits, uint32_t base, int32_t * result)
 {
     uint8_t negative;
-    int32_t result = 0;
+    uint64_t value;
+    int8_t status = parse_number(ptr, digits, base, INT32_MAX, 1, &negative, &value);
+
+    *result = 0;
+    if (status == DATA_OVERFLOW)
+    {
+        *result = negative ? INT32_MIN : INT32_MAX;
+    }
+    else if (status == DATA_OK)
+    {
+        // the magnitude of INT32_MIN wraps to itself
+        *result = (int32_t)(negative ? 0u - (uint32_t) value : (uint32_t) value);
+    }
+    return status;
+}
+
+/**
+ * @brief Converts an ASCII string into a signed 64 bit integer and checks it
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ * @param int64_t * result - where to save the converted number
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
+ **/
+int8_t my_atoi64_checked(uint8_t * ptr, uint8_t digits, uint32_t base, int64_t * result)
+{
+    uint8_t negative;
+    uint64_t value;
+    int8_t status = parse_number(ptr, digits, base, INT64_MAX, 1, &negative, &value);
+
+    *result = 0;
+    if (status == DATA_OVERFLOW)
+    {
+        *result = negative ? INT64_MIN : INT64_MAX;
+    }
+    else if (status == DATA_OK)
+    {
+        // the magnitude of INT64_MIN wraps to itself
+        *result = (int64_t)(negative ? 0u - value : value);
+    }
+    return status;
+}
+
+/**
+ * @brief Converts an ASCII string into an unsigned 64 bit integer and checks it
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert, a '-' is invalid
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0
+ * @param uint32_t base - number base from 2 to 36
+ * @param uint64_t * result - where to save the converted number
+ *
+ * @return int8_t - DATA_OK, DATA_INVALID or DATA_OVERFLOW
+ **/
+int8_t my_atou64_checked(uint8_t * ptr, uint8_t digits, uint32_t base, uint64_t * result)
+{
+    uint8_t negative;
+    int8_t status = parse_number(ptr, digits, base, UINT64_MAX, 0, &negative, result);
+
+    if (status == DATA_OVERFLOW)
+    {
+        *result = UINT64_MAX;
+    }
+    else if (status == DATA_INVALID)
+    {
+        *result = 0;
+    }
+    return status;
+}
+
+/* The conversion as it always was: characters that are no digit count as
+ * 0, the string ends at its terminator, and the value wraps. The callers
+ * keep as many low bits as their type has. */
+static uint64_t atoi_lenient(uint8_t * ptr, uint8_t digits, uint32_t base)
+{
+    uint8_t negative = 0;
+    uint64_t result = 0;
+    uint8_t ended = 0;
 
     if (*ptr == '-')
     {
@@ -161,37 +971,82 @@ int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base)
         ptr++;
         digits--;
     }
-    else
+    if (digits < 2) return 0;
+    if ((base < 2) || (base > DATA_MAX_BASE)) return 0;
+
+    for (digits--; digits > 0; digits--)
     {
-        negative = 0;
+        ended |= (*ptr == 0);
+        result = result * base + (ended ? 0 : ch_to_digit(*ptr));
+        ptr++;
     }
-    
-    /* Incorrect arguments handling */
-    /* There should be at least 2 characters, where the last one is a strign null terminator */
-    if (digits < 2) return 0; 
-    if ((base < 2) || (base > 16)) return 0;
 
-    /* 
-    digits will show current digit position (starting from 0)
-    
-    The biggest (=starting) current position equals number of string characters 
-    minus the terminal null and minus 1, because position number starts with zero, not one */
-    digits = digits -2;
+    return negative ? 0u - result : result;
+}
 
-    while ((digits >= 1) && (*ptr != 0))
+/**
+ * @brief  Converts data back from an ASCII represented string into an 
+ * integer type.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ * 
+ * @return int32_t - converted number
+ **/
+int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base) 
+{
+    int32_t result;
+
+    if (my_atoi_checked(ptr, digits, base, &result) == DATA_INVALID)
     {
-        /*
-        curr_multipier = pow(base, curr_position);
-        curr_digit = ch_to_digit(*ptr);
-        */
-        result += ch_to_digit(*ptr) * pow(base, digits);
-        ptr++;
-        digits--;
+        return (int32_t)(uint32_t) atoi_lenient(ptr, digits, base);
     }
+    return result;
+}
 
-    result += ch_to_digit(*ptr); // the last digit character, it doesn't need pow
-    
-    if (negative) result = -result;
-    
+/**
+ * @brief Converts an ASCII string into a signed 64 bit integer
+ *
+ * Saturates on overflow; a string that is not a number is read the
+ * lenient way, like my_atoi does.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0 and '-'
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return int64_t - converted number
+ **/
+int64_t my_atoi64(uint8_t * ptr, uint8_t digits, uint32_t base)
+{
+    int64_t result;
+
+    if (my_atoi64_checked(ptr, digits, base, &result) == DATA_INVALID)
+    {
+        return (int64_t) atoi_lenient(ptr, digits, base);
+    }
+    return result;
+}
+
+/**
+ * @brief Converts an ASCII string into an unsigned 64 bit integer
+ *
+ * Saturates on overflow; a string that is not a number is read the
+ * lenient way, like my_atoi does.
+ *
+ * @param uint8_t * ptr - pointer to a number in a form of string to convert
+ * @param uint8_t digits - number of characters in the given sting, including terminator \0
+ * @param uint32_t base - number base from 2 to 36
+ *
+ * @return uint64_t - converted number
+ **/
+uint64_t my_atou64(uint8_t * ptr, uint8_t digits, uint32_t base)
+{
+    uint64_t result;
+
+    if (my_atou64_checked(ptr, digits, base, &result) == DATA_INVALID)
+    {
+        return atoi_lenient(ptr, digits, base);
+    }
     return result;
 }
\ No newline at end of file
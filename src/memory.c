@@ -20,249 +20,4187 @@
  * @date April 1 2017, 11/2024
  *
  */
+#if defined (HOST)
+  /* pthreads, and the MAP_HUGETLB/MAP_POPULATE/madvise extensions of
+   * mmap under -std=c99 */
+  #define _GNU_SOURCE
+#endif
+
 #include "memory.h"
+#include "platform.h"
+
+#if defined (HOST)
+  #include <pthread.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+#elif defined (MEMORY_THREAD_CACHE)
+  #error "MEMORY_THREAD_CACHE is only supported on the HOST platform"
+#endif
+
+/* -DMEMORY_NO_SIMD builds the portable kernels of the MSP432 build on the host */
+#if defined (HOST) && (defined (__x86_64__) || defined (__i386__)) && !defined (MEMORY_NO_SIMD)
+  #define MEMORY_X86_SIMD
+  #include <immintrin.h>
+#endif
 
 /***********************************************************
- Function Definitions
+ Copy engine helpers
 ***********************************************************/
-void set_value(char * ptr, unsigned int index, char value){
-  ptr[index] = value;
+
+/* The widest general purpose register: 64 bit on the host, 32 bit on
+ * the Cortex-M4. Word loops move one of these per access. */
+typedef uintptr_t mem_word_t;
+
+/* Aliasing-safe views of a word, aligned and unaligned */
+typedef mem_word_t __attribute__((__may_alias__)) mem_aword_t;
+typedef struct { mem_word_t w; } __attribute__((__packed__, __may_alias__)) mem_uword_t;
+typedef struct { uint16_t v; } __attribute__((__packed__, __may_alias__)) mem_u16_t;
+typedef struct { uint32_t v; } __attribute__((__packed__, __may_alias__)) mem_u32_t;
+typedef struct { uint64_t v; } __attribute__((__packed__, __may_alias__)) mem_u64_t;
+
+#define MEM_WORD_SIZE      (sizeof(mem_word_t))
+#define MEM_WORD_MASK      (MEM_WORD_SIZE - 1)
+
+typedef void (*memcopy_kernel_t)(uint8_t * dst, const uint8_t * src, size_t length);
+
+/* Plain byte loop - used for prologues and epilogues of the word kernels */
+static void memcopy_bytes(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  while (length != 0)
+  {
+    *dst = *src;
+    dst++;
+    src++;
+    length--;
+  }
+}
+
+/* Copies up to 16 bytes with two possibly overlapping accesses. Both loads
+ * happen before the first store, so the result is right for any overlap of
+ * src and dst, in either direction. */
+static void memcopy_small(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  if (length >= 8)
+  {
+    uint64_t a = ((const mem_u64_t *) src)->v;
+    uint64_t b = ((const mem_u64_t *)(src + length - 8))->v;
+    ((mem_u64_t *) dst)->v = a;
+    ((mem_u64_t *)(dst + length - 8))->v = b;
+  }
+  else if (length >= 4)
+  {
+    uint32_t a = ((const mem_u32_t *) src)->v;
+    uint32_t b = ((const mem_u32_t *)(src + length - 4))->v;
+    ((mem_u32_t *) dst)->v = a;
+    ((mem_u32_t *)(dst + length - 4))->v = b;
+  }
+  else if (length >= 2)
+  {
+    uint16_t a = ((const mem_u16_t *) src)->v;
+    uint16_t b = ((const mem_u16_t *)(src + length - 2))->v;
+    ((mem_u16_t *) dst)->v = a;
+    ((mem_u16_t *)(dst + length - 2))->v = b;
+  }
+  else if (length == 1)
+  {
+    *dst = *src;
+  }
+}
+
+/* Portable word-wide kernel. This is the engine of the MSP432 build and the
+ * fallback on any host without SIMD support. */
+static void memcopy_word(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  mem_aword_t * d;
+  size_t head;
+
+  if (length <= 16)
+  {
+    memcopy_small(dst, src, length);
+    return;
+  }
+
+  /* alignment prologue: bring dst to a word boundary */
+  head = (MEM_WORD_SIZE - ((uintptr_t)dst & MEM_WORD_MASK)) & MEM_WORD_MASK;
+  memcopy_bytes(dst, src, head);
+  dst += head;
+  src += head;
+  length -= head;
+
+  d = (mem_aword_t *) dst;
+  if (((uintptr_t)src & MEM_WORD_MASK) == 0)
+  {
+    const mem_aword_t * s = (const mem_aword_t *) src;
+
+    while (length >= 4 * MEM_WORD_SIZE)
+    {
+      d[0] = s[0];
+      d[1] = s[1];
+      d[2] = s[2];
+      d[3] = s[3];
+      d += 4;
+      s += 4;
+      length -= 4 * MEM_WORD_SIZE;
+    }
+    while (length >= MEM_WORD_SIZE)
+    {
+      *d++ = *s++;
+      length -= MEM_WORD_SIZE;
+    }
+  }
+  else
+  {
+    /* src is misaligned relative to dst - aligned stores, unaligned loads */
+    const mem_uword_t * s = (const mem_uword_t *) src;
+
+    while (length >= MEM_WORD_SIZE)
+    {
+      *d++ = (s++)->w;
+      length -= MEM_WORD_SIZE;
+    }
+  }
+
+  /* tail epilogue */
+  memcopy_bytes((uint8_t *) d, src + ((uint8_t *) d - dst), length);
+}
+
+#ifdef MEMORY_X86_SIMD
+/* The SIMD kernels load the first and the last vector of the block before
+ * anything is stored and write them after the main loop. This replaces the
+ * byte prologue and epilogue, and it keeps the kernels correct when my_memmove
+ * runs them on overlapping blocks: the main loop only ever reads source bytes
+ * that no store has reached yet. */
+
+/* Copies up to 32 bytes, all loads before the first store */
+static void memcopy_small_sse2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  if (length >= 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *) src);
+    __m128i b = _mm_loadu_si128((const __m128i *)(src + length - 16));
+    _mm_storeu_si128((__m128i *) dst, a);
+    _mm_storeu_si128((__m128i *)(dst + length - 16), b);
+  }
+  else
+  {
+    memcopy_small(dst, src, length);
+  }
+}
+
+/* SSE2 kernel: 16 byte aligned stores, unaligned loads */
+static void memcopy_sse2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  __m128i head;
+  __m128i tail;
+  uint8_t * d;
+  const uint8_t * s;
+  size_t offset;
+
+  if (length <= 32)
+  {
+    memcopy_small_sse2(dst, src, length);
+    return;
+  }
+
+  head = _mm_loadu_si128((const __m128i *) src);
+  tail = _mm_loadu_si128((const __m128i *)(src + length - 16));
+
+  /* first aligned store above dst; the head vector covers the bytes below */
+  offset = 16 - ((uintptr_t)dst & 15);
+  d = dst + offset;
+  s = src + offset;
+  length -= offset;
+
+  while (length >= 64 + 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(s + 0));
+    __m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+    __m128i e = _mm_loadu_si128((const __m128i *)(s + 48));
+    _mm_store_si128((__m128i *)(d + 0), a);
+    _mm_store_si128((__m128i *)(d + 16), b);
+    _mm_store_si128((__m128i *)(d + 32), c);
+    _mm_store_si128((__m128i *)(d + 48), e);
+    d += 64;
+    s += 64;
+    length -= 64;
+  }
+  while (length > 16)
+  {
+    _mm_store_si128((__m128i *) d, _mm_loadu_si128((const __m128i *) s));
+    d += 16;
+    s += 16;
+    length -= 16;
+  }
+
+  /* the tail vector covers the last (length <= 16) bytes */
+  _mm_storeu_si128((__m128i *) dst, head);
+  _mm_storeu_si128((__m128i *)(d + length - 16), tail);
+}
+
+/* Copies up to 64 bytes, all loads before the first store */
+__attribute__((target("avx2")))
+static void memcopy_small_avx2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  if (length >= 32)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i *) src);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(src + length - 32));
+    _mm256_storeu_si256((__m256i *) dst, a);
+    _mm256_storeu_si256((__m256i *)(dst + length - 32), b);
+  }
+  else
+  {
+    memcopy_small_sse2(dst, src, length);
+  }
+}
+
+/* AVX2 kernel: 32 byte aligned stores, unaligned loads */
+__attribute__((target("avx2")))
+static void memcopy_avx2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  __m256i head;
+  __m256i tail;
+  uint8_t * d;
+  const uint8_t * s;
+  size_t offset;
+
+  if (length <= 64)
+  {
+    memcopy_small_avx2(dst, src, length);
+    return;
+  }
+
+  head = _mm256_loadu_si256((const __m256i *) src);
+  tail = _mm256_loadu_si256((const __m256i *)(src + length - 32));
+
+  offset = 32 - ((uintptr_t)dst & 31);
+  d = dst + offset;
+  s = src + offset;
+  length -= offset;
+
+  while (length >= 128 + 32)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(s + 0));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i *)(s + 64));
+    __m256i e = _mm256_loadu_si256((const __m256i *)(s + 96));
+    _mm256_store_si256((__m256i *)(d + 0), a);
+    _mm256_store_si256((__m256i *)(d + 32), b);
+    _mm256_store_si256((__m256i *)(d + 64), c);
+    _mm256_store_si256((__m256i *)(d + 96), e);
+    d += 128;
+    s += 128;
+    length -= 128;
+  }
+  while (length > 32)
+  {
+    _mm256_store_si256((__m256i *) d, _mm256_loadu_si256((const __m256i *) s));
+    d += 32;
+    s += 32;
+    length -= 32;
+  }
+
+  _mm256_storeu_si256((__m256i *) dst, head);
+  _mm256_storeu_si256((__m256i *)(d + length - 32), tail);
+}
+#endif /* MEMORY_X86_SIMD */
+
+/* Backward kernels copy from the last byte to the first. They are used by
+ * my_memmove when dst is above src and the two blocks overlap; dst and src
+ * point to the start of the blocks, as for the forward kernels. */
+
+static void memcopy_back_bytes(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  dst += length;
+  src += length;
+  while (length != 0)
+  {
+    dst--;
+    src--;
+    *dst = *src;
+    length--;
+  }
+}
+
+static void memcopy_back_word(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  uint8_t * d_end = dst + length;
+  const uint8_t * s_end = src + length;
+  mem_aword_t * d;
+  const mem_uword_t * s;
+  size_t tail;
+
+  if (length <= 16)
+  {
+    memcopy_small(dst, src, length);
+    return;
+  }
+
+  /* alignment prologue: bring the end of dst to a word boundary */
+  tail = (uintptr_t)d_end & MEM_WORD_MASK;
+  memcopy_back_bytes(d_end - tail, s_end - tail, tail);
+  d_end -= tail;
+  s_end -= tail;
+  length -= tail;
+
+  d = (mem_aword_t *) d_end;
+  s = (const mem_uword_t *) s_end;
+  while (length >= MEM_WORD_SIZE)
+  {
+    d--;
+    s--;
+    *d = s->w;
+    length -= MEM_WORD_SIZE;
+  }
+
+  /* head epilogue */
+  memcopy_back_bytes(dst, src, length);
+}
+
+#ifdef MEMORY_X86_SIMD
+/* Mirror images of the forward SIMD kernels: the main loop walks down from
+ * the aligned end of dst, head and tail vectors are stored last */
+static void memcopy_back_sse2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  __m128i head;
+  __m128i tail;
+  uint8_t * d_end;
+  const uint8_t * s_end;
+  size_t offset;
+
+  if (length <= 32)
+  {
+    memcopy_small_sse2(dst, src, length);
+    return;
+  }
+
+  head = _mm_loadu_si128((const __m128i *) src);
+  tail = _mm_loadu_si128((const __m128i *)(src + length - 16));
+
+  /* last aligned store below the end of dst; the tail vector covers the rest */
+  offset = ((uintptr_t)(dst + length - 1) & 15) + 1;
+  d_end = dst + length - offset;
+  s_end = src + length - offset;
+
+  while (d_end - dst >= 64 + 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(s_end - 16));
+    __m128i b = _mm_loadu_si128((const __m128i *)(s_end - 32));
+    __m128i c = _mm_loadu_si128((const __m128i *)(s_end - 48));
+    __m128i e = _mm_loadu_si128((const __m128i *)(s_end - 64));
+    _mm_store_si128((__m128i *)(d_end - 16), a);
+    _mm_store_si128((__m128i *)(d_end - 32), b);
+    _mm_store_si128((__m128i *)(d_end - 48), c);
+    _mm_store_si128((__m128i *)(d_end - 64), e);
+    d_end -= 64;
+    s_end -= 64;
+  }
+  while (d_end - dst > 16)
+  {
+    d_end -= 16;
+    s_end -= 16;
+    _mm_store_si128((__m128i *) d_end, _mm_loadu_si128((const __m128i *) s_end));
+  }
+
+  /* the head vector covers the first (<= 16) bytes */
+  _mm_storeu_si128((__m128i *)(dst + length - 16), tail);
+  _mm_storeu_si128((__m128i *) dst, head);
+}
+
+__attribute__((target("avx2")))
+static void memcopy_back_avx2(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  __m256i head;
+  __m256i tail;
+  uint8_t * d_end;
+  const uint8_t * s_end;
+  size_t offset;
+
+  if (length <= 64)
+  {
+    memcopy_small_avx2(dst, src, length);
+    return;
+  }
+
+  head = _mm256_loadu_si256((const __m256i *) src);
+  tail = _mm256_loadu_si256((const __m256i *)(src + length - 32));
+
+  offset = ((uintptr_t)(dst + length - 1) & 31) + 1;
+  d_end = dst + length - offset;
+  s_end = src + length - offset;
+
+  while (d_end - dst >= 128 + 32)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(s_end - 32));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(s_end - 64));
+    __m256i c = _mm256_loadu_si256((const __m256i *)(s_end - 96));
+    __m256i e = _mm256_loadu_si256((const __m256i *)(s_end - 128));
+    _mm256_store_si256((__m256i *)(d_end - 32), a);
+    _mm256_store_si256((__m256i *)(d_end - 64), b);
+    _mm256_store_si256((__m256i *)(d_end - 96), c);
+    _mm256_store_si256((__m256i *)(d_end - 128), e);
+    d_end -= 128;
+    s_end -= 128;
+  }
+  while (d_end - dst > 32)
+  {
+    d_end -= 32;
+    s_end -= 32;
+    _mm256_store_si256((__m256i *) d_end, _mm256_loadu_si256((const __m256i *) s_end));
+  }
+
+  _mm256_storeu_si256((__m256i *)(dst + length - 32), tail);
+  _mm256_storeu_si256((__m256i *) dst, head);
+}
+#endif /* MEMORY_X86_SIMD */
+
+/***********************************************************
+ Fill engine helpers
+***********************************************************/
+
+/* Fills of at least this many bytes bypass the cache with non-temporal
+ * stores on the host. Override at build time with -DMEMSET_NT_THRESHOLD=n
+ * or at run time with set_memset_nt_threshold(). */
+#ifndef MEMSET_NT_THRESHOLD
+  #define MEMSET_NT_THRESHOLD (4UL * 1024UL * 1024UL)
+#endif
+
+typedef void (*memset_kernel_t)(uint8_t * dst, uint8_t value, size_t length);
+
+static size_t memset_nt_threshold = MEMSET_NT_THRESHOLD;
+
+/* Fills up to 16 bytes with two possibly overlapping stores */
+static void memset_small(uint8_t * dst, uint8_t value, size_t length)
+{
+  uint64_t pattern = 0x0101010101010101ULL * value;
+
+  if (length >= 8)
+  {
+    ((mem_u64_t *) dst)->v = pattern;
+    ((mem_u64_t *)(dst + length - 8))->v = pattern;
+  }
+  else if (length >= 4)
+  {
+    ((mem_u32_t *) dst)->v = (uint32_t) pattern;
+    ((mem_u32_t *)(dst + length - 4))->v = (uint32_t) pattern;
+  }
+  else if (length >= 2)
+  {
+    ((mem_u16_t *) dst)->v = (uint16_t) pattern;
+    ((mem_u16_t *)(dst + length - 2))->v = (uint16_t) pattern;
+  }
+  else if (length == 1)
+  {
+    *dst = value;
+  }
+}
+
+/* Portable word-wide fill, used by the MSP432 build */
+static void memset_word(uint8_t * dst, uint8_t value, size_t length)
+{
+  mem_word_t pattern = ((mem_word_t) -1 / 0xFF) * value;
+  mem_aword_t * d;
+  size_t head;
+
+  if (length <= 16)
+  {
+    memset_small(dst, value, length);
+    return;
+  }
+
+  /* the unaligned head and tail are written as whole words, overlapping the
+     aligned middle */
+  ((mem_uword_t *) dst)->w = pattern;
+  ((mem_uword_t *)(dst + length - MEM_WORD_SIZE))->w = pattern;
+
+  head = MEM_WORD_SIZE - ((uintptr_t)dst & MEM_WORD_MASK);
+  d = (mem_aword_t *)(dst + head);
+  length = (length - head) / MEM_WORD_SIZE;
+
+  while (length >= 4)
+  {
+    d[0] = pattern;
+    d[1] = pattern;
+    d[2] = pattern;
+    d[3] = pattern;
+    d += 4;
+    length -= 4;
+  }
+  while (length != 0)
+  {
+    *d++ = pattern;
+    length--;
+  }
+}
+
+#ifdef MEMORY_X86_SIMD
+static void memset_sse2(uint8_t * dst, uint8_t value, size_t length)
+{
+  __m128i v = _mm_set1_epi8((char) value);
+  uint8_t * d;
+  uint8_t * d_last;
+
+  if (length <= 16)
+  {
+    memset_small(dst, value, length);
+    return;
+  }
+
+  d_last = dst + length - 16;
+  _mm_storeu_si128((__m128i *) dst, v);
+  d = (uint8_t *)(((uintptr_t)dst + 16) & ~(uintptr_t)15);
+
+  while (d + 64 <= d_last)
+  {
+    _mm_store_si128((__m128i *)(d + 0), v);
+    _mm_store_si128((__m128i *)(d + 16), v);
+    _mm_store_si128((__m128i *)(d + 32), v);
+    _mm_store_si128((__m128i *)(d + 48), v);
+    d += 64;
+  }
+  while (d < d_last)
+  {
+    _mm_store_si128((__m128i *) d, v);
+    d += 16;
+  }
+  _mm_storeu_si128((__m128i *) d_last, v);
+}
+
+__attribute__((target("avx2")))
+static void memset_avx2(uint8_t * dst, uint8_t value, size_t length)
+{
+  __m256i v = _mm256_set1_epi8((char) value);
+  uint8_t * d;
+  uint8_t * d_last;
+
+  if (length <= 32)
+  {
+    memset_sse2(dst, value, length);
+    return;
+  }
+
+  d_last = dst + length - 32;
+  _mm256_storeu_si256((__m256i *) dst, v);
+  d = (uint8_t *)(((uintptr_t)dst + 32) & ~(uintptr_t)31);
+
+  while (d + 128 <= d_last)
+  {
+    _mm256_store_si256((__m256i *)(d + 0), v);
+    _mm256_store_si256((__m256i *)(d + 32), v);
+    _mm256_store_si256((__m256i *)(d + 64), v);
+    _mm256_store_si256((__m256i *)(d + 96), v);
+    d += 128;
+  }
+  while (d < d_last)
+  {
+    _mm256_store_si256((__m256i *) d, v);
+    d += 32;
+  }
+  _mm256_storeu_si256((__m256i *) d_last, v);
+}
+
+/* Streaming fills for blocks far bigger than the cache. The stores go around
+ * the cache hierarchy, so a big clear does not evict the working set. The
+ * fence orders them before any later store of the caller. */
+static void memset_stream_sse2(uint8_t * dst, uint8_t value, size_t length)
+{
+  __m128i v = _mm_set1_epi8((char) value);
+  uint8_t * d;
+  uint8_t * d_last = dst + length - 16;
+
+  _mm_storeu_si128((__m128i *) dst, v);
+  d = (uint8_t *)(((uintptr_t)dst + 16) & ~(uintptr_t)15);
+
+  while (d + 64 <= d_last)
+  {
+    _mm_stream_si128((__m128i *)(d + 0), v);
+    _mm_stream_si128((__m128i *)(d + 16), v);
+    _mm_stream_si128((__m128i *)(d + 32), v);
+    _mm_stream_si128((__m128i *)(d + 48), v);
+    d += 64;
+  }
+  while (d < d_last)
+  {
+    _mm_stream_si128((__m128i *) d, v);
+    d += 16;
+  }
+  _mm_sfence();
+  _mm_storeu_si128((__m128i *) d_last, v);
+}
+
+__attribute__((target("avx2")))
+static void memset_stream_avx2(uint8_t * dst, uint8_t value, size_t length)
+{
+  __m256i v = _mm256_set1_epi8((char) value);
+  uint8_t * d;
+  uint8_t * d_last = dst + length - 32;
+
+  _mm256_storeu_si256((__m256i *) dst, v);
+  d = (uint8_t *)(((uintptr_t)dst + 32) & ~(uintptr_t)31);
+
+  while (d + 128 <= d_last)
+  {
+    _mm256_stream_si256((__m256i *)(d + 0), v);
+    _mm256_stream_si256((__m256i *)(d + 32), v);
+    _mm256_stream_si256((__m256i *)(d + 64), v);
+    _mm256_stream_si256((__m256i *)(d + 96), v);
+    d += 128;
+  }
+  while (d < d_last)
+  {
+    _mm256_stream_si256((__m256i *) d, v);
+    d += 32;
+  }
+  _mm_sfence();
+  _mm256_storeu_si256((__m256i *) d_last, v);
+}
+#endif /* MEMORY_X86_SIMD */
+
+/***********************************************************
+ Reverse engine helpers
+***********************************************************/
+
+/* Byte swap of a whole word: REV on the Cortex-M4, BSWAP on the host */
+#if defined (MSP432)
+  #define MEM_BSWAP_WORD(x) __REV(x)
+#elif UINTPTR_MAX == 0xFFFFFFFFFFFFFFFFULL
+  #define MEM_BSWAP_WORD(x) __builtin_bswap64(x)
+#else
+  #define MEM_BSWAP_WORD(x) __builtin_bswap32(x)
+#endif
+
+typedef void (*reverse_kernel_t)(uint8_t * src, size_t length);
+
+/* The reverse kernels work in place from both ends: a block is loaded from
+ * the front and one from the back, each is reversed in registers and they
+ * are stored at the opposite ends. When the middle that is left is shorter
+ * than two blocks, the kernel hands it to the next narrower one. */
+
+static void reverse_bytes(uint8_t * src, size_t length)
+{
+  uint8_t * lo = src;
+  uint8_t * hi = src + length;
+  uint8_t tmp;
+
+  while (hi - lo >= 2)
+  {
+    hi--;
+    tmp = *lo;
+    *lo = *hi;
+    *hi = tmp;
+    lo++;
+  }
+}
+
+static void reverse_word(uint8_t * src, size_t length)
+{
+  mem_uword_t * lo = (mem_uword_t *) src;
+  mem_uword_t * hi = (mem_uword_t *)(src + length);
+  mem_word_t a;
+  mem_word_t b;
+
+  while (length >= 2 * MEM_WORD_SIZE)
+  {
+    hi--;
+    a = lo->w;
+    b = hi->w;
+    lo->w = MEM_BSWAP_WORD(b);
+    hi->w = MEM_BSWAP_WORD(a);
+    lo++;
+    length -= 2 * MEM_WORD_SIZE;
+  }
+
+  reverse_bytes((uint8_t *) lo, length);
+}
+
+#ifdef MEMORY_X86_SIMD
+__attribute__((target("ssse3")))
+static void reverse_ssse3(uint8_t * src, size_t length)
+{
+  const __m128i mask = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                     7, 6, 5, 4, 3, 2, 1, 0);
+  uint8_t * lo = src;
+  uint8_t * hi = src + length;
+  __m128i a;
+  __m128i b;
+
+  while (length >= 2 * 16)
+  {
+    hi -= 16;
+    a = _mm_loadu_si128((const __m128i *) lo);
+    b = _mm_loadu_si128((const __m128i *) hi);
+    _mm_storeu_si128((__m128i *) lo, _mm_shuffle_epi8(b, mask));
+    _mm_storeu_si128((__m128i *) hi, _mm_shuffle_epi8(a, mask));
+    lo += 16;
+    length -= 2 * 16;
+  }
+
+  reverse_word(lo, length);
+}
+
+/* vpshufb only shuffles inside 128 bit lanes, the lane swap is done by vpermq */
+__attribute__((target("avx2")))
+static void reverse_avx2(uint8_t * src, size_t length)
+{
+  const __m256i mask = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                        7, 6, 5, 4, 3, 2, 1, 0,
+                                        15, 14, 13, 12, 11, 10, 9, 8,
+                                        7, 6, 5, 4, 3, 2, 1, 0);
+  uint8_t * lo = src;
+  uint8_t * hi = src + length;
+  __m256i a;
+  __m256i b;
+
+  while (length >= 2 * 32)
+  {
+    hi -= 32;
+    a = _mm256_loadu_si256((const __m256i *) lo);
+    b = _mm256_loadu_si256((const __m256i *) hi);
+    a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, mask), 0x4E);
+    b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, mask), 0x4E);
+    _mm256_storeu_si256((__m256i *) lo, b);
+    _mm256_storeu_si256((__m256i *) hi, a);
+    lo += 32;
+    length -= 2 * 32;
+  }
+
+  reverse_ssse3(lo, length);
+}
+
+/* vpermb reverses a whole 64 byte register in one instruction */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void reverse_avx512vbmi(uint8_t * src, size_t length)
+{
+  const __m512i mask = _mm512_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15,
+                                       16, 17, 18, 19, 20, 21, 22, 23,
+                                       24, 25, 26, 27, 28, 29, 30, 31,
+                                       32, 33, 34, 35, 36, 37, 38, 39,
+                                       40, 41, 42, 43, 44, 45, 46, 47,
+                                       48, 49, 50, 51, 52, 53, 54, 55,
+                                       56, 57, 58, 59, 60, 61, 62, 63);
+  uint8_t * lo = src;
+  uint8_t * hi = src + length;
+  __m512i a;
+  __m512i b;
+
+  while (length >= 2 * 64)
+  {
+    hi -= 64;
+    a = _mm512_loadu_si512((const void *) lo);
+    b = _mm512_loadu_si512((const void *) hi);
+    _mm512_storeu_si512((void *) lo, _mm512_permutexvar_epi8(mask, b));
+    _mm512_storeu_si512((void *) hi, _mm512_permutexvar_epi8(mask, a));
+    lo += 64;
+    length -= 2 * 64;
+  }
+
+  reverse_avx2(lo, length);
+}
+#endif /* MEMORY_X86_SIMD */
+
+/***********************************************************
+ Byte swap engine helpers
+***********************************************************/
+
+/* Byte swaps of 16 bit pairs, 32 and 64 bit values: REV16 and REV on the
+ * Cortex-M4, shifts and BSWAP on the host */
+#if defined (MSP432)
+  #define MEM_REV16_PAIR(x) __REV16(x)
+  #define MEM_REV32(x)      __REV(x)
+  #define MEM_REV64(x)      (((uint64_t) __REV((uint32_t)(x)) << 32) | __REV((uint32_t)((x) >> 32)))
+#else
+  #define MEM_REV16_PAIR(x) ((((x) & 0x00FF00FFu) << 8) | (((x) >> 8) & 0x00FF00FFu))
+  #define MEM_REV32(x)      __builtin_bswap32(x)
+  #define MEM_REV64(x)      __builtin_bswap64(x)
+#endif
+
+/* Swaps the bytes of every (width) byte element of (length) bytes. Every
+ * element is loaded before it is stored, so dst may be equal to src. */
+typedef void (*bswap_kernel_t)(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width);
+
+static void bswap_word(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width)
+{
+  uint16_t h;
+
+  if (width == 2)
+  {
+    while (length >= 4)
+    {
+      ((mem_u32_t *) dst)->v = MEM_REV16_PAIR(((const mem_u32_t *) src)->v);
+      dst += 4;
+      src += 4;
+      length -= 4;
+    }
+    if (length >= 2)
+    {
+      h = ((const mem_u16_t *) src)->v;
+      ((mem_u16_t *) dst)->v = (uint16_t)((h << 8) | (h >> 8));
+    }
+  }
+  else if (width == 4)
+  {
+    while (length >= 4)
+    {
+      ((mem_u32_t *) dst)->v = MEM_REV32(((const mem_u32_t *) src)->v);
+      dst += 4;
+      src += 4;
+      length -= 4;
+    }
+  }
+  else
+  {
+    while (length >= 8)
+    {
+      ((mem_u64_t *) dst)->v = MEM_REV64(((const mem_u64_t *) src)->v);
+      dst += 8;
+      src += 8;
+      length -= 8;
+    }
+  }
+}
+
+#ifdef MEMORY_X86_SIMD
+__attribute__((target("ssse3")))
+static __m128i bswap_mask_ssse3(uint8_t width)
+{
+  if (width == 2)
+  {
+    return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  }
+  if (width == 4)
+  {
+    return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  }
+  return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+}
+
+__attribute__((target("ssse3")))
+static void bswap_ssse3(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width)
+{
+  const __m128i mask = bswap_mask_ssse3(width);
+
+  while (length >= 16)
+  {
+    _mm_storeu_si128((__m128i *) dst,
+                     _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) src), mask));
+    dst += 16;
+    src += 16;
+    length -= 16;
+  }
+
+  bswap_word(dst, src, length, width);
+}
+
+/* Elements never cross a 128 bit lane, so vpshufb needs no lane fix up */
+__attribute__((target("avx2")))
+static void bswap_avx2(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width)
+{
+  const __m256i mask = _mm256_broadcastsi128_si256(bswap_mask_ssse3(width));
+  __m256i a;
+  __m256i b;
+
+  while (length >= 64)
+  {
+    a = _mm256_loadu_si256((const __m256i *) src);
+    b = _mm256_loadu_si256((const __m256i *)(src + 32));
+    _mm256_storeu_si256((__m256i *) dst, _mm256_shuffle_epi8(a, mask));
+    _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_shuffle_epi8(b, mask));
+    dst += 64;
+    src += 64;
+    length -= 64;
+  }
+
+  bswap_ssse3(dst, src, length, width);
+}
+#endif /* MEMORY_X86_SIMD */
+
+/***********************************************************
+ Compare and search engine helpers
+***********************************************************/
+
+/* Lowest and highest set bit of a word, for turning a byte mask into
+ * an index. CLZ exists on the Cortex-M4, CTZ is RBIT + CLZ there. */
+#if UINTPTR_MAX == 0xFFFFFFFFFFFFFFFFULL
+  #define MEM_CTZ_WORD(x) __builtin_ctzll(x)
+  #define MEM_CLZ_WORD(x) __builtin_clzll(x)
+#else
+  #define MEM_CTZ_WORD(x) __builtin_ctz(x)
+  #define MEM_CLZ_WORD(x) __builtin_clz(x)
+#endif
+
+#define MEM_WORD_ONES  ((mem_word_t) -1 / 0xFF)   /* 0x0101...01 */
+#define MEM_WORD_HIGHS (MEM_WORD_ONES * 0x80)     /* 0x8080...80 */
+
+/* Sets the top bit of exactly the zero bytes of (v): the low seven bits
+ * are added to 0x7F, which carries into the top bit unless they are all
+ * zero, and never into the next byte. */
+#define MEM_ZERO_BYTES(v) \
+  (~((((v) & ~MEM_WORD_HIGHS) + ~MEM_WORD_HIGHS) | (v)) & MEM_WORD_HIGHS)
+
+/* The kernels return an index, and (length) when there is none */
+typedef size_t (*mismatch_kernel_t)(const uint8_t * a, const uint8_t * b, size_t length);
+typedef size_t (*find_kernel_t)(const uint8_t * src, size_t length, uint8_t value);
+
+static size_t mismatch_word(const uint8_t * a, const uint8_t * b, size_t length)
+{
+  mem_word_t x;
+  size_t i = 0;
+
+  while (length - i >= MEM_WORD_SIZE)
+  {
+    x = ((const mem_uword_t *)(a + i))->w ^ ((const mem_uword_t *)(b + i))->w;
+    if (x != 0)
+    {
+      /* both platforms are little endian: the first byte is the lowest */
+      return i + MEM_CTZ_WORD(x) / 8;
+    }
+    i += MEM_WORD_SIZE;
+  }
+  while ((i < length) && (a[i] == b[i]))
+  {
+    i++;
+  }
+  return i;
+}
+
+static size_t find_word(const uint8_t * src, size_t length, uint8_t value)
+{
+  mem_word_t pattern = MEM_WORD_ONES * value;
+  mem_word_t z;
+  size_t i = 0;
+
+  while (length - i >= MEM_WORD_SIZE)
+  {
+    z = MEM_ZERO_BYTES(((const mem_uword_t *)(src + i))->w ^ pattern);
+    if (z != 0)
+    {
+      return i + MEM_CTZ_WORD(z) / 8;
+    }
+    i += MEM_WORD_SIZE;
+  }
+  while ((i < length) && (src[i] != value))
+  {
+    i++;
+  }
+  return i;
+}
+
+static size_t find_last_word(const uint8_t * src, size_t length, uint8_t value)
+{
+  mem_word_t pattern = MEM_WORD_ONES * value;
+  mem_word_t z;
+  size_t i = length;
+
+  while (i >= MEM_WORD_SIZE)
+  {
+    i -= MEM_WORD_SIZE;
+    z = MEM_ZERO_BYTES(((const mem_uword_t *)(src + i))->w ^ pattern);
+    if (z != 0)
+    {
+      return i + MEM_WORD_SIZE - 1 - MEM_CLZ_WORD(z) / 8;
+    }
+  }
+  while (i != 0)
+  {
+    i--;
+    if (src[i] == value)
+    {
+      return i;
+    }
+  }
+  return length;
+}
+
+#ifdef MEMORY_X86_SIMD
+/* The SIMD kernels finish with one vector that overlaps the bytes already
+ * checked, which cannot hold a match, instead of a scalar tail. */
+
+static size_t mismatch_sse2(const uint8_t * a, const uint8_t * b, size_t length)
+{
+  uint32_t mask;
+  size_t i = 0;
+
+  if (length < 16)
+  {
+    return mismatch_word(a, b, length);
+  }
+  while (1)
+  {
+    if (length - i < 16)
+    {
+      i = length - 16;
+    }
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                            _mm_loadu_si128((const __m128i *)(b + i))));
+    if (mask != 0xFFFF)
+    {
+      return i + __builtin_ctz(~mask);
+    }
+    i += 16;
+    if (i == length)
+    {
+      return length;
+    }
+  }
+}
+
+static size_t find_sse2(const uint8_t * src, size_t length, uint8_t value)
+{
+  const __m128i pattern = _mm_set1_epi8((char) value);
+  uint32_t mask;
+  size_t i = 0;
+
+  if (length < 16)
+  {
+    return find_word(src, length, value);
+  }
+  while (1)
+  {
+    if (length - i < 16)
+    {
+      i = length - 16;
+    }
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(src + i)), pattern));
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+    i += 16;
+    if (i == length)
+    {
+      return length;
+    }
+  }
+}
+
+static size_t find_last_sse2(const uint8_t * src, size_t length, uint8_t value)
+{
+  const __m128i pattern = _mm_set1_epi8((char) value);
+  uint32_t mask;
+  size_t i = length;
+
+  if (length < 16)
+  {
+    return find_last_word(src, length, value);
+  }
+  while (i != 0)
+  {
+    i = (i >= 16) ? (i - 16) : 0;
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(src + i)), pattern));
+    if (mask != 0)
+    {
+      return i + 31 - __builtin_clz(mask);
+    }
+  }
+  return length;
+}
+
+/* 64 bytes per step, the two halves are tested together and only split
+ * up once one of them has a hit */
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const uint8_t * a, const uint8_t * b, size_t length)
+{
+  __m256i eq0;
+  __m256i eq1;
+  uint32_t mask;
+  size_t i = 0;
+
+  while (length - i >= 64)
+  {
+    eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                            _mm256_loadu_si256((const __m256i *)(b + i)));
+    eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 32)),
+                            _mm256_loadu_si256((const __m256i *)(b + i + 32)));
+    if ((uint32_t) _mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) != 0xFFFFFFFFu)
+    {
+      mask = (uint32_t) _mm256_movemask_epi8(eq0);
+      if (mask != 0xFFFFFFFFu)
+      {
+        return i + __builtin_ctz(~mask);
+      }
+      return i + 32 + __builtin_ctz(~(uint32_t) _mm256_movemask_epi8(eq1));
+    }
+    i += 64;
+  }
+  return i + mismatch_sse2(a + i, b + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(const uint8_t * src, size_t length, uint8_t value)
+{
+  const __m256i pattern = _mm256_set1_epi8((char) value);
+  __m256i eq0;
+  __m256i eq1;
+  uint32_t mask;
+  size_t i = 0;
+
+  while (length - i >= 64)
+  {
+    eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(src + i)), pattern);
+    eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(src + i + 32)), pattern);
+    if (_mm256_movemask_epi8(_mm256_or_si256(eq0, eq1)) != 0)
+    {
+      mask = (uint32_t) _mm256_movemask_epi8(eq0);
+      if (mask != 0)
+      {
+        return i + __builtin_ctz(mask);
+      }
+      return i + 32 + __builtin_ctz((uint32_t) _mm256_movemask_epi8(eq1));
+    }
+    i += 64;
+  }
+  return i + find_sse2(src + i, length - i, value);
+}
+
+__attribute__((target("avx2")))
+static size_t find_last_avx2(const uint8_t * src, size_t length, uint8_t value)
+{
+  const __m256i pattern = _mm256_set1_epi8((char) value);
+  __m256i eq0;
+  __m256i eq1;
+  uint32_t mask;
+  size_t i = length;
+  size_t found;
+
+  while (i >= 64)
+  {
+    i -= 64;
+    eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(src + i)), pattern);
+    eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(src + i + 32)), pattern);
+    if (_mm256_movemask_epi8(_mm256_or_si256(eq0, eq1)) != 0)
+    {
+      mask = (uint32_t) _mm256_movemask_epi8(eq1);
+      if (mask != 0)
+      {
+        return i + 32 + 31 - __builtin_clz(mask);
+      }
+      return i + 31 - __builtin_clz((uint32_t) _mm256_movemask_epi8(eq0));
+    }
+  }
+  found = find_last_sse2(src, i, value);
+  return (found == i) ? length : found;
+}
+#endif /* MEMORY_X86_SIMD */
+
+/***********************************************************
+ Checksum engine helpers
+***********************************************************/
+
+/* The fused kernels copy (length) bytes and run a checksum over them on
+ * the way through the registers. They take and return the raw running
+ * state: the inverted CRC, or s2 << 16 | s1 for Adler-32. */
+typedef uint32_t (*checksum_kernel_t)(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state);
+
+/* Reflected polynomials: CRC-32 (ISO 3309, Ethernet, zlib) is the one the
+ * MSP432 CRC32 module computes, CRC-32C (Castagnoli) the one of the SSE4.2
+ * crc32 instruction */
+#define CRC32_POLY_REFLECTED  (0xEDB88320u)
+#define CRC32C_POLY_REFLECTED (0x82F63B78u)
+
+/* Largest number of bytes Adler-32 can sum before s2 may overflow 32 bits */
+#define ADLER32_BASE (65521u)
+#define ADLER32_NMAX (5552u)
+
+static uint32_t crc32_table[256];
+static uint32_t crc32c_table[256];
+
+static void crc_build_table(uint32_t * table, uint32_t poly)
+{
+  uint32_t i;
+  uint32_t bit;
+  uint32_t crc;
+
+  for (i = 0; i < 256; i++)
+  {
+    crc = i;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+    }
+    table[i] = crc;
+  }
+}
+
+/* Table driven path: a word is loaded, stored, and folded into the CRC
+ * one byte at a time. Same result as the SSE4.2, PCLMUL and MSP432 paths. */
+static uint32_t copy_crc_table(const uint32_t * table, uint8_t * dst, const uint8_t * src,
+                               size_t length, uint32_t crc)
+{
+  uint32_t w;
+
+  while (length >= 4)
+  {
+    w = ((const mem_u32_t *) src)->v;
+    ((mem_u32_t *) dst)->v = w;
+    /* little endian: the lowest byte is the first one */
+    crc = (crc >> 8) ^ table[(crc ^ w) & 0xFF];
+    crc = (crc >> 8) ^ table[(crc ^ (w >> 8)) & 0xFF];
+    crc = (crc >> 8) ^ table[(crc ^ (w >> 16)) & 0xFF];
+    crc = (crc >> 8) ^ table[(crc ^ (w >> 24)) & 0xFF];
+    dst += 4;
+    src += 4;
+    length -= 4;
+  }
+  while (length != 0)
+  {
+    *dst = *src;
+    crc = (crc >> 8) ^ table[(crc ^ *src) & 0xFF];
+    dst++;
+    src++;
+    length--;
+  }
+  return crc;
+}
+
+static uint32_t copy_crc32_table(uint8_t * dst, const uint8_t * src, size_t length, uint32_t crc)
+{
+  return copy_crc_table(crc32_table, dst, src, length, crc);
+}
+
+static uint32_t copy_crc32c_table(uint8_t * dst, const uint8_t * src, size_t length, uint32_t crc)
+{
+  return copy_crc_table(crc32c_table, dst, src, length, crc);
+}
+
+/* Adler-32 with the modulo taken once per ADLER32_NMAX bytes */
+static uint32_t copy_adler32_word(uint8_t * dst, const uint8_t * src, size_t length, uint32_t adler)
+{
+  uint32_t s1 = adler & 0xFFFF;
+  uint32_t s2 = adler >> 16;
+  size_t n;
+
+  while (length != 0)
+  {
+    n = (length < ADLER32_NMAX) ? length : ADLER32_NMAX;
+    length -= n;
+    while (n >= 4)
+    {
+      ((mem_u32_t *) dst)->v = ((const mem_u32_t *) src)->v;
+      s1 += src[0];
+      s2 += s1;
+      s1 += src[1];
+      s2 += s1;
+      s1 += src[2];
+      s2 += s1;
+      s1 += src[3];
+      s2 += s1;
+      dst += 4;
+      src += 4;
+      n -= 4;
+    }
+    while (n != 0)
+    {
+      *dst = *src;
+      s1 += *src;
+      s2 += s1;
+      dst++;
+      src++;
+      n--;
+    }
+    s1 %= ADLER32_BASE;
+    s2 %= ADLER32_BASE;
+  }
+  return (s2 << 16) | s1;
+}
+
+#if defined (MSP432)
+/* The CRC32 module in ISO 3309 mode: bytes written to DI32 are taken LSB
+ * first and RESR32 holds the bit reversed result, which is the state of the
+ * reflected table algorithm. Seeding takes the state bit reversed as well. */
+static uint32_t copy_crc32_msp432(uint8_t * dst, const uint8_t * src, size_t length, uint32_t crc)
+{
+  crc = __RBIT(crc);
+  CRC32->INIRES32_LO = (uint16_t) crc;
+  CRC32->INIRES32_HI = (uint16_t)(crc >> 16);
+  while (length != 0)
+  {
+    *dst = *src;
+    *(volatile uint8_t *) &CRC32->DI32 = *src;
+    dst++;
+    src++;
+    length--;
+  }
+  return ((uint32_t) CRC32->RESR32_HI << 16) | CRC32->RESR32_LO;
+}
+#endif
+
+#ifdef MEMORY_X86_SIMD
+/* One crc32 instruction per 8 bytes, the store rides along for free */
+__attribute__((target("sse4.2")))
+static uint32_t copy_crc32c_sse42(uint8_t * dst, const uint8_t * src, size_t length, uint32_t crc)
+{
+  uint64_t c = crc;
+  uint64_t w;
+
+  while (length >= 8)
+  {
+    w = ((const mem_u64_t *) src)->v;
+    ((mem_u64_t *) dst)->v = w;
+    c = _mm_crc32_u64(c, w);
+    dst += 8;
+    src += 8;
+    length -= 8;
+  }
+  crc = (uint32_t) c;
+  while (length != 0)
+  {
+    *dst = *src;
+    crc = _mm_crc32_u8(crc, *src);
+    dst++;
+    src++;
+    length--;
+  }
+  return crc;
+}
+
+/* Folding with carry-less multiplies, after Intel's "Fast CRC Computation
+ * for Generic Polynomials Using PCLMULQDQ". Four 16 byte lanes are folded
+ * by 64 bytes per step, then into one lane, then reduced to 32 bits with a
+ * Barrett reduction. Each 16 byte block is stored as soon as it is loaded. */
+__attribute__((target("sse4.1,pclmul")))
+static uint32_t copy_crc32_pclmul(uint8_t * dst, const uint8_t * src, size_t length, uint32_t crc)
+{
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+  const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124LL);
+  const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+  __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+  __m128i y5, y6, y7, y8;
+
+  if (length < 64)
+  {
+    return copy_crc32_table(dst, src, length, crc);
+  }
+
+  x1 = _mm_loadu_si128((const __m128i *)(src + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *)(src + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(src + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(src + 0x30));
+  _mm_storeu_si128((__m128i *)(dst + 0x00), x1);
+  _mm_storeu_si128((__m128i *)(dst + 0x10), x2);
+  _mm_storeu_si128((__m128i *)(dst + 0x20), x3);
+  _mm_storeu_si128((__m128i *)(dst + 0x30), x4);
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crc));
+  src += 64;
+  dst += 64;
+  length -= 64;
+
+  while (length >= 64)
+  {
+    x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+    y5 = _mm_loadu_si128((const __m128i *)(src + 0x00));
+    y6 = _mm_loadu_si128((const __m128i *)(src + 0x10));
+    y7 = _mm_loadu_si128((const __m128i *)(src + 0x20));
+    y8 = _mm_loadu_si128((const __m128i *)(src + 0x30));
+    _mm_storeu_si128((__m128i *)(dst + 0x00), y5);
+    _mm_storeu_si128((__m128i *)(dst + 0x10), y6);
+    _mm_storeu_si128((__m128i *)(dst + 0x20), y7);
+    _mm_storeu_si128((__m128i *)(dst + 0x30), y8);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+    src += 64;
+    dst += 64;
+    length -= 64;
+  }
+
+  /* four lanes into one */
+  x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  while (length >= 16)
+  {
+    x2 = _mm_loadu_si128((const __m128i *) src);
+    _mm_storeu_si128((__m128i *) dst, x2);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    src += 16;
+    dst += 16;
+    length -= 16;
+  }
+
+  /* 128 bits to 64 */
+  x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  /* Barrett reduction to 32 bits */
+  x2 = _mm_and_si128(x1, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+  x2 = _mm_and_si128(x2, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  crc = (uint32_t) _mm_extract_epi32(x1, 1);
+
+  return copy_crc32_table(dst, src, length, crc);
+}
+
+/* 32 bytes per step: psadbw sums the bytes for s1, pmaddubsw weighs them
+ * by their distance to the end of the block for s2. s1 of every earlier
+ * step is added 32 times through (v_ps << 5). */
+__attribute__((target("ssse3")))
+static uint32_t copy_adler32_ssse3(uint8_t * dst, const uint8_t * src, size_t length, uint32_t adler)
+{
+  const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                     24, 23, 22, 21, 20, 19, 18, 17);
+  const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                     8, 7, 6, 5, 4, 3, 2, 1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  uint32_t s1 = adler & 0xFFFF;
+  uint32_t s2 = adler >> 16;
+  size_t blocks = length / 32;
+  size_t n;
+  __m128i v_ps;
+  __m128i v_s1;
+  __m128i v_s2;
+  __m128i b1;
+  __m128i b2;
+
+  length -= blocks * 32;
+  while (blocks != 0)
+  {
+    n = (blocks < ADLER32_NMAX / 32) ? blocks : ADLER32_NMAX / 32;
+    blocks -= n;
+
+    v_ps = _mm_set_epi32(0, 0, 0, (int)(s1 * n));
+    v_s2 = _mm_set_epi32(0, 0, 0, (int) s2);
+    v_s1 = zero;
+    do
+    {
+      b1 = _mm_loadu_si128((const __m128i *) src);
+      b2 = _mm_loadu_si128((const __m128i *)(src + 16));
+      _mm_storeu_si128((__m128i *) dst, b1);
+      _mm_storeu_si128((__m128i *)(dst + 16), b2);
+
+      v_ps = _mm_add_epi32(v_ps, v_s1);
+      v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b1, zero));
+      v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b2, zero));
+      v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(b1, tap1), ones));
+      v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(b2, tap2), ones));
+      src += 32;
+      dst += 32;
+    } while (--n != 0);
+
+    v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+    v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+    v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+    s1 += (uint32_t) _mm_cvtsi128_si32(v_s1);
+    v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+    v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+    s2 = (uint32_t) _mm_cvtsi128_si32(v_s2);
+
+    s1 %= ADLER32_BASE;
+    s2 %= ADLER32_BASE;
+  }
+
+  return copy_adler32_word(dst, src, length, (s2 << 16) | s1);
+}
+#endif /* MEMORY_X86_SIMD */
+
+static void memcopy_resolve(uint8_t * dst, const uint8_t * src, size_t length);
+static void memcopy_back_resolve(uint8_t * dst, const uint8_t * src, size_t length);
+static void memset_resolve(uint8_t * dst, uint8_t value, size_t length);
+static void memset_stream_resolve(uint8_t * dst, uint8_t value, size_t length);
+static void reverse_resolve(uint8_t * src, size_t length);
+static void bswap_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width);
+static size_t mismatch_resolve(const uint8_t * a, const uint8_t * b, size_t length);
+static size_t find_resolve(const uint8_t * src, size_t length, uint8_t value);
+static size_t find_last_resolve(const uint8_t * src, size_t length, uint8_t value);
+static uint32_t crc32_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state);
+static uint32_t crc32c_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state);
+static uint32_t adler32_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state);
+
+/* Selected copy kernel. Starts at the resolver, which replaces itself
+ * with the best kernel for this CPU on the first call. */
+static memcopy_kernel_t memcopy_kernel = memcopy_resolve;
+static memcopy_kernel_t memcopy_back_kernel = memcopy_back_resolve;
+static memset_kernel_t memset_kernel = memset_resolve;
+static memset_kernel_t memset_stream_kernel = memset_stream_resolve;
+static reverse_kernel_t reverse_kernel = reverse_resolve;
+static bswap_kernel_t bswap_kernel = bswap_resolve;
+static mismatch_kernel_t mismatch_kernel = mismatch_resolve;
+static find_kernel_t find_kernel = find_resolve;
+static find_kernel_t find_last_kernel = find_last_resolve;
+static checksum_kernel_t crc32_kernel = crc32_resolve;
+static checksum_kernel_t crc32c_kernel = crc32c_resolve;
+static checksum_kernel_t adler32_kernel = adler32_resolve;
+
+/* Picks the copy kernels by CPU feature detection */
+static void memory_select_kernels(void)
+{
+  crc_build_table(crc32_table, CRC32_POLY_REFLECTED);
+  crc_build_table(crc32c_table, CRC32C_POLY_REFLECTED);
+
+#ifdef MEMORY_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    memcopy_kernel = memcopy_avx2;
+    memcopy_back_kernel = memcopy_back_avx2;
+    memset_kernel = memset_avx2;
+    memset_stream_kernel = memset_stream_avx2;
+    mismatch_kernel = mismatch_avx2;
+    find_kernel = find_avx2;
+    find_last_kernel = find_last_avx2;
+  }
+  else if (__builtin_cpu_supports("sse2"))
+  {
+    memcopy_kernel = memcopy_sse2;
+    memcopy_back_kernel = memcopy_back_sse2;
+    memset_kernel = memset_sse2;
+    memset_stream_kernel = memset_stream_sse2;
+    mismatch_kernel = mismatch_sse2;
+    find_kernel = find_sse2;
+    find_last_kernel = find_last_sse2;
+  }
+  else
+  {
+    memcopy_kernel = memcopy_word;
+    memcopy_back_kernel = memcopy_back_word;
+    memset_kernel = memset_word;
+    memset_stream_kernel = memset_word;
+    mismatch_kernel = mismatch_word;
+    find_kernel = find_word;
+    find_last_kernel = find_last_word;
+  }
+
+  if (__builtin_cpu_supports("avx512vbmi"))
+  {
+    reverse_kernel = reverse_avx512vbmi;
+  }
+  else if (__builtin_cpu_supports("avx2"))
+  {
+    reverse_kernel = reverse_avx2;
+  }
+  else if (__builtin_cpu_supports("ssse3"))
+  {
+    reverse_kernel = reverse_ssse3;
+  }
+  else
+  {
+    reverse_kernel = reverse_word;
+  }
+
+  if (__builtin_cpu_supports("avx2"))
+  {
+    bswap_kernel = bswap_avx2;
+  }
+  else if (__builtin_cpu_supports("ssse3"))
+  {
+    bswap_kernel = bswap_ssse3;
+  }
+  else
+  {
+    bswap_kernel = bswap_word;
+  }
+
+  crc32c_kernel = __builtin_cpu_supports("sse4.2") ? copy_crc32c_sse42 : copy_crc32c_table;
+  crc32_kernel = (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) ?
+                 copy_crc32_pclmul : copy_crc32_table;
+  adler32_kernel = __builtin_cpu_supports("ssse3") ? copy_adler32_ssse3 : copy_adler32_word;
+#else
+  /* no streaming stores on the Cortex-M4: it has no data cache to protect */
+  memcopy_kernel = memcopy_word;
+  memcopy_back_kernel = memcopy_back_word;
+  memset_kernel = memset_word;
+  memset_stream_kernel = memset_word;
+  reverse_kernel = reverse_word;
+  bswap_kernel = bswap_word;
+  mismatch_kernel = mismatch_word;
+  find_kernel = find_word;
+  find_last_kernel = find_last_word;
+  crc32c_kernel = copy_crc32c_table;
+  adler32_kernel = copy_adler32_word;
+#if defined (MSP432)
+  crc32_kernel = copy_crc32_msp432;
+#else
+  crc32_kernel = copy_crc32_table;
+#endif
+#endif
+}
+
+static void memcopy_resolve(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  memory_select_kernels();
+  memcopy_kernel(dst, src, length);
+}
+
+static void memcopy_back_resolve(uint8_t * dst, const uint8_t * src, size_t length)
+{
+  memory_select_kernels();
+  memcopy_back_kernel(dst, src, length);
+}
+
+static void memset_resolve(uint8_t * dst, uint8_t value, size_t length)
+{
+  memory_select_kernels();
+  memset_kernel(dst, value, length);
+}
+
+static void memset_stream_resolve(uint8_t * dst, uint8_t value, size_t length)
+{
+  memory_select_kernels();
+  memset_stream_kernel(dst, value, length);
+}
+
+static void reverse_resolve(uint8_t * src, size_t length)
+{
+  memory_select_kernels();
+  reverse_kernel(src, length);
+}
+
+static void bswap_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint8_t width)
+{
+  memory_select_kernels();
+  bswap_kernel(dst, src, length, width);
+}
+
+static size_t mismatch_resolve(const uint8_t * a, const uint8_t * b, size_t length)
+{
+  memory_select_kernels();
+  return mismatch_kernel(a, b, length);
+}
+
+static size_t find_resolve(const uint8_t * src, size_t length, uint8_t value)
+{
+  memory_select_kernels();
+  return find_kernel(src, length, value);
+}
+
+static size_t find_last_resolve(const uint8_t * src, size_t length, uint8_t value)
+{
+  memory_select_kernels();
+  return find_last_kernel(src, length, value);
+}
+
+static uint32_t crc32_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state)
+{
+  memory_select_kernels();
+  return crc32_kernel(dst, src, length, state);
+}
+
+static uint32_t crc32c_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state)
+{
+  memory_select_kernels();
+  return crc32c_kernel(dst, src, length, state);
+}
+
+static uint32_t adler32_resolve(uint8_t * dst, const uint8_t * src, size_t length, uint32_t state)
+{
+  memory_select_kernels();
+  return adler32_kernel(dst, src, length, state);
+}
+
+#ifdef MEMORY_X86_SIMD
+/* Select the kernels at program startup, before any worker thread exists */
+__attribute__((constructor))
+static void memory_init_kernels(void)
+{
+  memory_select_kernels();
+}
+#endif
+
+/***********************************************************
+ Arena backend helpers
+***********************************************************/
+
+/* Arena blocks start on this many words, enough for the SIMD kernels on the
+ * host and for doubles on the Cortex-M4 */
+#if defined (MSP432)
+  #define ARENA_ALIGN_WORDS (2)
+#else
+  #define ARENA_ALIGN_WORDS (4)
+#endif
+
+typedef struct
+{
+  int32_t * base;  /* start of the region, NULL when the arena is off */
+  size_t size;     /* region size in words */
+  size_t top;      /* words handed out so far */
+  size_t last;     /* offset of the most recent block */
+  uint8_t owned;   /* region was taken from malloc by arena_init */
+} mem_arena_t;
+
+#ifdef MEMORY_ARENA_WORDS
+/* Build-time arena: reserve_words never calls malloc */
+static int32_t arena_static_region[MEMORY_ARENA_WORDS] __attribute__((aligned(16)));
+static mem_arena_t arena = {arena_static_region, MEMORY_ARENA_WORDS, 0, 0, 0};
+#else
+static mem_arena_t arena = {NULL, 0, 0, 0, 0};
+#endif
+
+/* Returns 1 if ptr lies inside the arena region */
+static uint8_t arena_owns(const int32_t * ptr)
+{
+  return (arena.base != NULL) && (ptr >= arena.base) && (ptr < arena.base + arena.size);
+}
+
+static int32_t * arena_reserve(size_t length)
+{
+  size_t start = arena.top;
+
+  length = (length + ARENA_ALIGN_WORDS - 1) & ~(size_t)(ARENA_ALIGN_WORDS - 1);
+  if (length > arena.size - start)
+  {
+    return NULL;
+  }
+
+  arena.last = start;
+  arena.top = start + length;
+  return arena.base + start;
+}
+
+/* Blocks are released in bulk by arena_rewind() or arena_reset(). Only the
+ * most recent block is given back at once, which covers the usual
+ * reserve - use - free sequence. */
+static void arena_free(int32_t * src)
+{
+  if (src == arena.base + arena.last)
+  {
+    arena.top = arena.last;
+  }
+}
+
+/* Grows the most recent block in place when the region has room for it */
+static uint8_t arena_grow(int32_t * src, size_t length)
+{
+  length = (length + ARENA_ALIGN_WORDS - 1) & ~(size_t)(ARENA_ALIGN_WORDS - 1);
+  if ((src != arena.base + arena.last) || (length > arena.size - arena.last))
+  {
+    return 0;
+  }
+
+  arena.top = arena.last + length;
+  return 1;
+}
+
+/***********************************************************
+ Pool backend helpers
+***********************************************************/
+
+/* Words needed to keep the free list link inside a free block */
+#define POOL_LINK_WORDS ((sizeof(void *) + sizeof(int32_t) - 1) / sizeof(int32_t))
+
+/* Pools attached to reserve_words, sorted by block size */
+static mem_pool_t * pool_list = NULL;
+
+/* Returns 1 if ptr lies inside the blocks of (pool) */
+static uint8_t pool_owns(const mem_pool_t * pool, const int32_t * ptr)
+{
+  return (ptr >= pool->storage) &&
+         (ptr < pool->storage + pool->block_words * pool->block_count);
+}
+
+/* Returns the attached pool that holds ptr, or NULL */
+static mem_pool_t * pool_find_owner(const int32_t * ptr)
+{
+  mem_pool_t * pool;
+
+  for (pool = pool_list; pool != NULL; pool = pool->next)
+  {
+    if (pool_owns(pool, ptr))
+    {
+      return pool;
+    }
+  }
+  return NULL;
+}
+
+/* Takes a block of at least (length) words from the smallest attached
+ * pool that has one free, or returns NULL */
+static int32_t * pool_list_reserve(size_t length)
+{
+  mem_pool_t * pool;
+  int32_t * block;
+
+  for (pool = pool_list; pool != NULL; pool = pool->next)
+  {
+    if (pool->block_words >= length)
+    {
+      block = pool_reserve(pool);
+      if (block != NULL)
+      {
+        return block;
+      }
+    }
+  }
+  return NULL;
+}
+
+#ifdef MEMORY_THREAD_CACHE
+/***********************************************************
+ Thread cache backend helpers
+***********************************************************/
+
+/* Blocks are sized in power of two classes from 16 bytes to 32 KB. Every
+ * thread keeps a magazine of free blocks per class and serves reserve_words
+ * and free_words from it without any lock. Magazines are refilled from, and
+ * flushed to, a shared depot in batches. Blocks freed by another thread go
+ * back to the thread that reserved them through a lock-free list, which that
+ * thread drains before it asks the depot. Bigger requests go to malloc. */
+#define TCACHE_MIN_SHIFT  (4)
+#define TCACHE_CLASSES    (12)
+#define TCACHE_MAG_SIZE   (64)
+#define TCACHE_BATCH      (32)
+#define TCACHE_LARGE      (0xFFFFFFFFu)
+
+typedef struct tcache tcache_t;
+
+/* Placed in front of every block; keeps the block 16 byte aligned */
+typedef struct
+{
+  tcache_t * owner;     /* thread that reserved the block */
+  uint32_t size_class;  /* class index, or TCACHE_LARGE */
+} __attribute__((aligned(16))) tcache_header_t;
+
+struct tcache
+{
+  tcache_header_t * slots[TCACHE_CLASSES][TCACHE_MAG_SIZE];
+  uint32_t count[TCACHE_CLASSES];
+  tcache_header_t * remote;   /* blocks freed by other threads */
+  tcache_t * next_orphan;     /* cache of an exited thread, waiting for reuse */
+};
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  tcache_header_t * head;     /* free blocks, linked through their first word */
+} tcache_depot_t;
+
+/* Link to the next block of a list, kept in the first word after the header */
+#define TCACHE_LINK(h) (*(tcache_header_t **)((h) + 1))
+
+static __thread tcache_t * tcache_self = NULL;
+static tcache_depot_t tcache_depot[TCACHE_CLASSES];
+static tcache_t * tcache_orphans = NULL;
+static pthread_mutex_t tcache_orphan_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t tcache_key;
+
+static size_t tcache_class_bytes(uint32_t size_class)
+{
+  return (size_t)1 << (size_class + TCACHE_MIN_SHIFT);
+}
+
+/* Returns the smallest class holding (bytes), or TCACHE_LARGE */
+static uint32_t tcache_class_of(size_t bytes)
+{
+  uint32_t shift;
+
+  if (bytes <= tcache_class_bytes(0))
+  {
+    return 0;
+  }
+  shift = (uint32_t)(sizeof(unsigned long) * 8 - __builtin_clzl((unsigned long)(bytes - 1)));
+  if (shift - TCACHE_MIN_SHIFT >= TCACHE_CLASSES)
+  {
+    return TCACHE_LARGE;
+  }
+  return shift - TCACHE_MIN_SHIFT;
+}
+
+/* Moves (count) blocks from the top of a magazine to the depot */
+static void tcache_flush(tcache_t * cache, uint32_t size_class, uint32_t count)
+{
+  tcache_depot_t * depot = &tcache_depot[size_class];
+  tcache_header_t * block;
+
+  pthread_mutex_lock(&depot->lock);
+  while ((count != 0) && (cache->count[size_class] != 0))
+  {
+    block = cache->slots[size_class][--cache->count[size_class]];
+    TCACHE_LINK(block) = depot->head;
+    depot->head = block;
+    count--;
+  }
+  pthread_mutex_unlock(&depot->lock);
+}
+
+/* Puts a free block into its magazine, flushing half of a full one first */
+static void tcache_put(tcache_t * cache, tcache_header_t * block)
+{
+  uint32_t size_class = block->size_class;
+
+  if (cache->count[size_class] == TCACHE_MAG_SIZE)
+  {
+    tcache_flush(cache, size_class, TCACHE_BATCH);
+  }
+  cache->slots[size_class][cache->count[size_class]++] = block;
+}
+
+/* Takes back the blocks other threads have freed */
+static void tcache_drain_remote(tcache_t * cache)
+{
+  tcache_header_t * block;
+  tcache_header_t * next;
+
+  if (__atomic_load_n(&cache->remote, __ATOMIC_RELAXED) == NULL)
+  {
+    return;
+  }
+  block = __atomic_exchange_n(&cache->remote, NULL, __ATOMIC_ACQUIRE);
+  while (block != NULL)
+  {
+    next = TCACHE_LINK(block);
+    tcache_put(cache, block);
+    block = next;
+  }
+}
+
+/* Fills an empty magazine: own remote frees first, then one batch from
+ * the depot, then a new slab from malloc */
+static void tcache_refill(tcache_t * cache, uint32_t size_class)
+{
+  tcache_depot_t * depot = &tcache_depot[size_class];
+  tcache_header_t * block;
+  size_t block_bytes;
+  uint8_t * slab;
+  uint32_t i;
+
+  tcache_drain_remote(cache);
+  if (cache->count[size_class] != 0)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&depot->lock);
+  while ((depot->head != NULL) && (cache->count[size_class] < TCACHE_BATCH))
+  {
+    block = depot->head;
+    depot->head = TCACHE_LINK(block);
+    cache->slots[size_class][cache->count[size_class]++] = block;
+  }
+  pthread_mutex_unlock(&depot->lock);
+  if (cache->count[size_class] != 0)
+  {
+    return;
+  }
+
+  /* slabs are never given back to malloc, their blocks circulate */
+  block_bytes = sizeof(tcache_header_t) + tcache_class_bytes(size_class);
+  slab = (uint8_t *) malloc(block_bytes * TCACHE_BATCH);
+  if (slab == NULL)
+  {
+    return;
+  }
+  for (i = 0; i < TCACHE_BATCH; i++)
+  {
+    block = (tcache_header_t *)(slab + i * block_bytes);
+    block->size_class = size_class;
+    cache->slots[size_class][cache->count[size_class]++] = block;
+  }
+}
+
+/* Runs at thread exit: everything cached goes to the depot, and the cache
+ * itself waits on the orphan list for the next new thread. It cannot be
+ * freed, since blocks in use elsewhere still point to it as their owner. */
+static void tcache_thread_exit(void * arg)
+{
+  tcache_t * cache = (tcache_t *) arg;
+  uint32_t size_class;
+
+  tcache_drain_remote(cache);
+  for (size_class = 0; size_class < TCACHE_CLASSES; size_class++)
+  {
+    tcache_flush(cache, size_class, TCACHE_MAG_SIZE);
+  }
+
+  pthread_mutex_lock(&tcache_orphan_lock);
+  cache->next_orphan = tcache_orphans;
+  tcache_orphans = cache;
+  pthread_mutex_unlock(&tcache_orphan_lock);
+  tcache_self = NULL;
+}
+
+static void tcache_init_once(void)
+{
+  uint32_t size_class;
+
+  for (size_class = 0; size_class < TCACHE_CLASSES; size_class++)
+  {
+    pthread_mutex_init(&tcache_depot[size_class].lock, NULL);
+    tcache_depot[size_class].head = NULL;
+  }
+  pthread_key_create(&tcache_key, tcache_thread_exit);
+}
+
+/* Returns the cache of the calling thread, setting it up on first use */
+static tcache_t * tcache_get(void)
+{
+  tcache_t * cache = tcache_self;
+
+  if (cache != NULL)
+  {
+    return cache;
+  }
+
+  pthread_once(&tcache_once, tcache_init_once);
+  pthread_mutex_lock(&tcache_orphan_lock);
+  cache = tcache_orphans;
+  if (cache != NULL)
+  {
+    tcache_orphans = cache->next_orphan;
+  }
+  pthread_mutex_unlock(&tcache_orphan_lock);
+
+  if (cache == NULL)
+  {
+    cache = (tcache_t *) calloc(1, sizeof(tcache_t));
+    if (cache == NULL)
+    {
+      return NULL;
+    }
+  }
+  cache->next_orphan = NULL;
+  pthread_setspecific(tcache_key, cache);
+  tcache_self = cache;
+  return cache;
+}
+
+static int32_t * tcache_reserve(size_t length)
+{
+  size_t bytes = length * sizeof(int32_t);
+  uint32_t size_class = tcache_class_of(bytes);
+  tcache_t * cache;
+  tcache_header_t * block;
+
+  if (size_class == TCACHE_LARGE)
+  {
+    block = (tcache_header_t *) malloc(sizeof(tcache_header_t) + bytes);
+    if (block == NULL)
+    {
+      return NULL;
+    }
+    block->owner = NULL;
+    block->size_class = TCACHE_LARGE;
+    return (int32_t *)(block + 1);
+  }
+
+  cache = tcache_get();
+  if (cache == NULL)
+  {
+    return NULL;
+  }
+  if (cache->count[size_class] == 0)
+  {
+    tcache_refill(cache, size_class);
+    if (cache->count[size_class] == 0)
+    {
+      return NULL;
+    }
+  }
+
+  block = cache->slots[size_class][--cache->count[size_class]];
+  block->owner = cache;
+  return (int32_t *)(block + 1);
+}
+
+static void tcache_free(int32_t * src)
+{
+  tcache_header_t * block = ((tcache_header_t *) src) - 1;
+  tcache_t * owner = block->owner;
+  tcache_header_t * head;
+
+  if (block->size_class == TCACHE_LARGE)
+  {
+    free(block);
+    return;
+  }
+
+  if (owner == tcache_self)
+  {
+    tcache_put(owner, block);
+    return;
+  }
+
+  /* freed by another thread: push it onto the owner's remote list */
+  head = __atomic_load_n(&owner->remote, __ATOMIC_RELAXED);
+  do
+  {
+    TCACHE_LINK(block) = head;
+  } while (! __atomic_compare_exchange_n(&owner->remote, &head, block, 1,
+                                         __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+#endif /* MEMORY_THREAD_CACHE */
+
+#ifdef MEMORY_INSTRUMENT
+/***********************************************************
+ Allocation instrumentation helpers
+***********************************************************/
+
+/* Blocks handed out by reserve_words and not freed yet, kept in an open
+ * addressing hash table keyed by address. The table doubles when it gets
+ * 3/4 full and lives outside the instrumented allocator. */
+#define TRACE_INITIAL_SLOTS (256)
+#define TRACE_TOMBSTONE     ((int32_t *) 1)
+
+typedef struct
+{
+  int32_t * block;
+  size_t bytes;
+} trace_slot_t;
+
+static trace_slot_t * trace_table = NULL;
+static size_t trace_slots = 0;
+static size_t trace_used = 0;   /* live entries and tombstones */
+static mem_stats_t trace_stats;
+static uint8_t trace_exit_hooked = 0;
+
+#if defined (HOST)
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+  #define TRACE_LOCK()   pthread_mutex_lock(&trace_lock)
+  #define TRACE_UNLOCK() pthread_mutex_unlock(&trace_lock)
+#else
+  #define TRACE_LOCK()
+  #define TRACE_UNLOCK()
+#endif
+
+static size_t trace_hash(const int32_t * block, size_t slots)
+{
+  uintptr_t h = (uintptr_t) block;
+
+  h ^= h >> 17;
+  h *= (uintptr_t) 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h >> 7) & (slots - 1);
+}
+
+static void trace_insert(int32_t * block, size_t bytes)
+{
+  size_t i = trace_hash(block, trace_slots);
+
+  while ((trace_table[i].block != NULL) && (trace_table[i].block != TRACE_TOMBSTONE))
+  {
+    i = (i + 1) & (trace_slots - 1);
+  }
+  if (trace_table[i].block == NULL)
+  {
+    trace_used++;
+  }
+  trace_table[i].block = block;
+  trace_table[i].bytes = bytes;
+}
+
+/* Doubles the table (or rebuilds it without tombstones) */
+static uint8_t trace_grow(void)
+{
+  trace_slot_t * old_table = trace_table;
+  size_t old_slots = trace_slots;
+  size_t slots = (old_slots == 0) ? TRACE_INITIAL_SLOTS : old_slots;
+  size_t i;
+
+  if (trace_stats.blocks_in_flight * 2 >= slots)
+  {
+    slots *= 2;
+  }
+  trace_table = (trace_slot_t *) calloc(slots, sizeof(trace_slot_t));
+  if (trace_table == NULL)
+  {
+    trace_table = old_table;
+    return 0;
+  }
+  trace_slots = slots;
+  trace_used = 0;
+  for (i = 0; i < old_slots; i++)
+  {
+    if ((old_table[i].block != NULL) && (old_table[i].block != TRACE_TOMBSTONE))
+    {
+      trace_insert(old_table[i].block, old_table[i].bytes);
+    }
+  }
+  free(old_table);
+  return 1;
+}
+
+static void trace_exit_report(void)
+{
+  memory_dump_outstanding();
+}
+
+static void trace_reserve(int32_t * block, size_t bytes)
+{
+  size_t bucket;
+
+  TRACE_LOCK();
+  trace_stats.reserve_calls++;
+  if (block == NULL)
+  {
+    trace_stats.failed_reserves++;
+    TRACE_UNLOCK();
+    return;
+  }
+
+  bucket = 0;
+  while ((bucket < MEM_STATS_BUCKETS - 1) && (bytes > ((size_t)16 << bucket)))
+  {
+    bucket++;
+  }
+  trace_stats.size_histogram[bucket]++;
+  trace_stats.blocks_in_flight++;
+  trace_stats.bytes_in_flight += bytes;
+  if (trace_stats.bytes_in_flight > trace_stats.peak_bytes)
+  {
+    trace_stats.peak_bytes = trace_stats.bytes_in_flight;
+  }
+
+  if (((trace_used + 1) * 4 <= trace_slots * 3) || trace_grow())
+  {
+    trace_insert(block, bytes);
+  }
+  else
+  {
+    trace_stats.untracked++;
+  }
+
+  if (! trace_exit_hooked)
+  {
+    trace_exit_hooked = 1;
+    atexit(trace_exit_report);
+  }
+  TRACE_UNLOCK();
+}
+
+static void trace_free(int32_t * block)
+{
+  size_t i;
+
+  if (block == NULL)
+  {
+    return;
+  }
+
+  TRACE_LOCK();
+  trace_stats.free_calls++;
+  if (trace_slots != 0)
+  {
+    i = trace_hash(block, trace_slots);
+    while (trace_table[i].block != NULL)
+    {
+      if (trace_table[i].block == block)
+      {
+        trace_stats.blocks_in_flight--;
+        trace_stats.bytes_in_flight -= trace_table[i].bytes;
+        trace_table[i].block = TRACE_TOMBSTONE;
+        break;
+      }
+      i = (i + 1) & (trace_slots - 1);
+    }
+  }
+  TRACE_UNLOCK();
+}
+
+/* Forgets every block in [lo, hi), for blocks given back in bulk */
+static void trace_free_range(const int32_t * lo, const int32_t * hi)
+{
+  size_t i;
+
+  TRACE_LOCK();
+  for (i = 0; i < trace_slots; i++)
+  {
+    if ((trace_table[i].block != NULL) && (trace_table[i].block != TRACE_TOMBSTONE) &&
+        (trace_table[i].block >= lo) && (trace_table[i].block < hi))
+    {
+      trace_stats.blocks_in_flight--;
+      trace_stats.bytes_in_flight -= trace_table[i].bytes;
+      trace_table[i].block = TRACE_TOMBSTONE;
+    }
+  }
+  TRACE_UNLOCK();
+}
+
+  #define MEMORY_TRACE_RESERVE(block, bytes) trace_reserve((block), (bytes))
+  #define MEMORY_TRACE_FREE(block)           trace_free(block)
+  #define MEMORY_TRACE_FREE_RANGE(lo, hi)    trace_free_range((lo), (hi))
+#else
+  /* not instrumented: the hooks compile to nothing */
+  #define MEMORY_TRACE_RESERVE(block, bytes)
+  #define MEMORY_TRACE_FREE(block)
+  #define MEMORY_TRACE_FREE_RANGE(lo, hi)
+#endif /* MEMORY_INSTRUMENT */
+
+/***********************************************************
+ Parallel engine helpers
+***********************************************************/
+
+/* Copies and fills of at least this many bytes are split across worker
+ * threads on the host. Override at build time with
+ * -DMEMORY_PARALLEL_THRESHOLD=n or at run time with set_parallel_threshold(). */
+#ifndef MEMORY_PARALLEL_THRESHOLD
+  #define MEMORY_PARALLEL_THRESHOLD (64UL * 1024UL * 1024UL)
+#endif
+
+#define PARALLEL_MAX_THREADS (16)
+#define PARALLEL_PAGE_BYTES  (4096)
+
+typedef enum
+{
+  PARALLEL_OP_COPY,
+  PARALLEL_OP_FILL
+} parallel_op_t;
+
+static size_t parallel_threshold = MEMORY_PARALLEL_THRESHOLD;
+
+#if defined (HOST)
+/* A fork-join pool: the caller publishes a job and bumps the generation,
+ * worker k moves part k and the caller moves part 0 itself. Workers keep
+ * their index for life, so the same thread always first-touches the same
+ * share of a buffer. Only one job runs at a time; a caller that finds the
+ * pool busy does its work alone. */
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t start;       /* a new generation was published */
+  pthread_cond_t finished;    /* the last worker part is done */
+  pthread_mutex_t busy;       /* held by the caller running a job */
+  pthread_t threads[PARALLEL_MAX_THREADS];
+  uint32_t started;           /* workers created, indexes 1 to started */
+  uint64_t generation;
+  uint64_t spawn_generation;  /* generation before the one new workers join */
+  uint32_t parts;
+  uint32_t pending;           /* worker parts not done yet */
+  parallel_op_t op;
+  uint8_t * src;
+  uint8_t * dst;
+  size_t length;
+  uint8_t value;
+  uint8_t stream;             /* fill with streaming stores */
+} parallel_pool_t;
+
+static parallel_pool_t parallel_pool =
+{
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .start = PTHREAD_COND_INITIALIZER,
+  .finished = PTHREAD_COND_INITIALIZER,
+  .busy = PTHREAD_MUTEX_INITIALIZER,
+};
+#endif
+
+/* Start offset of part k of n. Inner boundaries are rounded up to a page
+ * of the destination, so no page is first touched by two threads. */
+static size_t parallel_bound(const uint8_t * dst, size_t length, uint32_t k, uint32_t parts)
+{
+  uintptr_t addr;
+  size_t offset;
+
+  if (k == 0)
+  {
+    return 0;
+  }
+  if (k >= parts)
+  {
+    return length;
+  }
+  addr = (uintptr_t) dst + (length / parts) * k;
+  addr = (addr + PARALLEL_PAGE_BYTES - 1) & ~(uintptr_t)(PARALLEL_PAGE_BYTES - 1);
+  offset = addr - (uintptr_t) dst;
+  return (offset < length) ? offset : length;
+}
+
+static void parallel_run_part(parallel_op_t op, uint8_t * src, uint8_t * dst,
+                              size_t length, uint8_t value, uint8_t stream,
+                              uint32_t k, uint32_t parts)
+{
+  size_t lo = parallel_bound(dst, length, k, parts);
+  size_t hi = parallel_bound(dst, length, k + 1, parts);
+
+  if (hi <= lo)
+  {
+    return;
+  }
+  if (op == PARALLEL_OP_COPY)
+  {
+    memcopy_kernel(dst + lo, src + lo, hi - lo);
+  }
+  else if (stream && (hi - lo >= 64))
+  {
+    memset_stream_kernel(dst + lo, value, hi - lo);
+  }
+  else
+  {
+    memset_kernel(dst + lo, value, hi - lo);
+  }
+}
+
+#if defined (HOST)
+static void * parallel_worker(void * arg)
+{
+  uint32_t k = (uint32_t)(uintptr_t) arg;
+  uint64_t seen;
+  parallel_pool_t * pool = &parallel_pool;
+
+  pthread_mutex_lock(&pool->lock);
+  seen = pool->spawn_generation;
+  while (1)
+  {
+    while (pool->generation == seen)
+    {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    seen = pool->generation;
+    if (k >= pool->parts)
+    {
+      continue;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    parallel_run_part(pool->op, pool->src, pool->dst, pool->length,
+                      pool->value, pool->stream, k, pool->parts);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->pending == 0)
+    {
+      pthread_cond_signal(&pool->finished);
+    }
+  }
+  return NULL;
+}
+
+/* Number of threads used when the caller passes 0 */
+static uint32_t parallel_default_threads(void)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (cpus < 1)
+  {
+    return 1;
+  }
+  return (cpus > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : (uint32_t) cpus;
+}
+#endif
+
+/* Splits one copy or fill into parts and runs them on the pool */
+static void parallel_run(parallel_op_t op, uint8_t * src, uint8_t * dst,
+                         size_t length, uint8_t value, uint32_t threads)
+{
+  uint8_t stream = (memset_nt_threshold != 0) && (length >= memset_nt_threshold);
+  uint32_t parts;
+#if defined (HOST)
+  parallel_pool_t * pool = &parallel_pool;
+
+  if (threads == 0)
+  {
+    threads = parallel_default_threads();
+  }
+  if (threads > PARALLEL_MAX_THREADS)
+  {
+    threads = PARALLEL_MAX_THREADS;
+  }
+  /* at least a page per part */
+  parts = threads;
+  if (parts > length / PARALLEL_PAGE_BYTES)
+  {
+    parts = (uint32_t)(length / PARALLEL_PAGE_BYTES);
+  }
+
+  if ((parts > 1) && (pthread_mutex_trylock(&pool->busy) == 0))
+  {
+    pthread_mutex_lock(&pool->lock);
+    pool->spawn_generation = pool->generation;
+    while (pool->started + 1 < parts)
+    {
+      if (pthread_create(&pool->threads[pool->started], NULL, parallel_worker,
+                         (void *)(uintptr_t)(pool->started + 1)) != 0)
+      {
+        break;
+      }
+      pool->started++;
+    }
+    if (parts > pool->started + 1)
+    {
+      parts = pool->started + 1;
+    }
+    pool->op = op;
+    pool->src = src;
+    pool->dst = dst;
+    pool->length = length;
+    pool->value = value;
+    pool->stream = stream;
+    pool->parts = parts;
+    pool->pending = parts - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    parallel_run_part(op, src, dst, length, value, stream, 0, parts);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending != 0)
+    {
+      pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->busy);
+    return;
+  }
+#else
+  (void) threads;
+#endif
+  parts = 1;
+  parallel_run_part(op, src, dst, length, value, stream, 0, parts);
+}
+
+/***********************************************************
+ Function Definitions
+***********************************************************/
+void set_value(char * ptr, unsigned int index, char value){
+  ptr[index] = value;
+}
+
+void clear_value(char * ptr, unsigned int index){
+  set_value(ptr, index, 0);
+}
+
+char get_value(char * ptr, unsigned int index){
+  return ptr[index];
+}
+
+void set_all(char * ptr, char value, unsigned int size){
+  unsigned int i;
+  for(i = 0; i < size; i++) {
+    set_value(ptr, i, value);
+  }
+}
+
+void clear_all(char * ptr, unsigned int size){
+  set_all(ptr, 0, size);
+}
+
+/************************** my FUNCTIONS*********************/
+
+/**
+ * @brief Moves (length) bytes from (src) to (dest) 
+ *
+ * The behavior should handle overlap of source and destination. 
+ * Copy should occur, with no data corruption.
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param uint8_t * dst - Pointer to destination
+ * @param size_t length - Number of bytes to move
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length)
+{
+  if (dst == src) {return dst;}
+
+  if ((dst > src) && (dst < src + length))
+  {
+    /* Handles the situation when src is the first block but dst 
+    overlaps it. In this case copying from the first element to the last 
+    will corrupt data. Copying from the last to the first is required */
+    memcopy_back_kernel(dst, src, length);
+  }
+  else
+  {
+    /* we should copy from start to end - it handles not-overlapped src and dst
+    and it handles overlapping, when dst if the first memory block by it's address.
+    Every forward kernel loads a block before it stores it and walks upwards, 
+    so a store never lands on source bytes that are still to be read */
+    memcopy_kernel(dst, src, length);
+  }
+
+  return dst;
+
+}
+
+/**
+ * @brief Copies (length) bytes from (src) to (dest) 
+ * 
+ * The behavior is undefined if there is overlap of source and 
+ * destination. Copy should still occur, but will likely corrupt
+ * your data.
+ *
+ * The work is done by the kernel selected at startup (AVX2, SSE2
+ * or the portable word loop). Every kernel copies strictly from the
+ * first byte to the last.
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param uint8_t * dst - Pointer to destination
+ * @param size_t length - Number of bytes to copy
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length)
+{
+  if ((parallel_threshold != 0) && (length >= parallel_threshold))
+  {
+    parallel_run(PARALLEL_OP_COPY, src, dst, length, 0, 0);
+  }
+  else
+  {
+    memcopy_kernel(dst, src, length);
+  }
+  return dst;
+}
+
+/**
+ * @brief Copies (length) bytes from (src) to (dst) on several threads
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint8_t threads - Number of threads, 0 for one per CPU
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_memcopy_parallel(uint8_t * src, uint8_t * dst, size_t length, uint8_t threads)
+{
+  parallel_run(PARALLEL_OP_COPY, src, dst, length, 0, threads);
+  return dst;
+}
+
+/**
+ * @brief Copies (length) bytes and returns the CRC-32 of them
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t crc - CRC of the data before, 0 to start
+ *
+ * @return - CRC-32 of the data so far
+ */
+uint32_t my_memcopy_crc32(uint8_t * src, uint8_t * dst, size_t length, uint32_t crc)
+{
+  return ~crc32_kernel(dst, src, length, ~crc);
+}
+
+/**
+ * @brief Copies (length) bytes and returns the CRC-32C of them
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t crc - CRC of the data before, 0 to start
+ *
+ * @return - CRC-32C of the data so far
+ */
+uint32_t my_memcopy_crc32c(uint8_t * src, uint8_t * dst, size_t length, uint32_t crc)
+{
+  return ~crc32c_kernel(dst, src, length, ~crc);
+}
+
+/**
+ * @brief Copies (length) bytes and returns the Adler-32 of them
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address
+ * @param size_t length - Number of bytes to copy
+ * @param uint32_t adler - Checksum of the data before, 1 to start
+ *
+ * @return - Adler-32 of the data so far
+ */
+uint32_t my_memcopy_adler32(uint8_t * src, uint8_t * dst, size_t length, uint32_t adler)
+{
+  return adler32_kernel(dst, src, length, adler);
+}
+
+/**
+ * @brief Moves a list of regions described by {src, dst, length}
+ *
+ * The list is sorted by source address, descriptors that continue each
+ * other in both source and destination are merged, and every merged run
+ * is moved by my_memmove while the next run is prefetched.
+ *
+ * @param mem_desc_t * list - Array of descriptors, reordered by the call
+ * @param size_t count - Number of descriptors
+ *
+ * @return - total number of bytes moved
+ */
+size_t my_memmove_sg(mem_desc_t * list, size_t count)
+{
+  mem_desc_t tmp;
+  size_t i;
+  size_t j;
+  size_t run_end;
+  size_t run_length;
+  size_t moved = 0;
+
+  /* insertion sort - lists are short and usually close to sorted already */
+  for (i = 1; i < count; i++)
+  {
+    tmp = list[i];
+    j = i;
+    while ((j > 0) && (list[j - 1].src > tmp.src))
+    {
+      list[j] = list[j - 1];
+      j--;
+    }
+    list[j] = tmp;
+  }
+
+  i = 0;
+  while (i < count)
+  {
+    /* grow the run while the next region continues this one on both sides */
+    run_length = list[i].length;
+    run_end = i + 1;
+    while ((run_end < count) &&
+           (list[run_end].src == list[i].src + run_length) &&
+           (list[run_end].dst == list[i].dst + run_length))
+    {
+      run_length += list[run_end].length;
+      run_end++;
+    }
+
+    if (run_end < count)
+    {
+      __builtin_prefetch(list[run_end].src, 0, 0);
+      __builtin_prefetch(list[run_end].dst, 1, 0);
+    }
+
+    my_memmove(list[i].src, list[i].dst, run_length);
+    moved += run_length;
+
+    while (i < run_end)
+    {
+      list[i].done = 1;
+      i++;
+    }
+  }
+
+  return moved;
+}
+
+/**
+ * @brief Set all (length) bytes at address (src) to a given (value)
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to a value
+ * @param uint8_t value - Value to be set
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value)
+{
+  if ((parallel_threshold != 0) && (length >= parallel_threshold))
+  {
+    parallel_run(PARALLEL_OP_FILL, NULL, src, length, value, 0);
+  }
+  else if ((memset_nt_threshold != 0) && (length >= memset_nt_threshold) && (length >= 64))
+  {
+    memset_stream_kernel(src, value, length);
+  }
+  else
+  {
+    memset_kernel(src, value, length);
+  }
+
+  return src;
+}
+
+/**
+ * @brief Sets the size from which my_memset uses streaming stores
+ *
+ * @param size_t threshold - Size in bytes, 0 never streams
+ */
+void set_memset_nt_threshold(size_t threshold)
+{
+  memset_nt_threshold = threshold;
+}
+
+/**
+ * @brief Returns the size from which my_memset uses streaming stores
+ *
+ * @return - size in bytes, 0 if streaming is off
+ */
+size_t get_memset_nt_threshold(void)
+{
+  return memset_nt_threshold;
+}
+
+/**
+ * @brief Set all (length) bytes at address (src) to a zero
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to 0
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memzero(uint8_t * src, size_t length)
+{
+  return my_memset(src,length,0);
+};
+
+/**
+ * @brief Sets (length) bytes at (src) to (value) on several threads
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to a value
+ * @param uint8_t value - Value to be set
+ * @param uint8_t threads - Number of threads, 0 for one per CPU
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memset_parallel(uint8_t * src, size_t length, uint8_t value, uint8_t threads)
+{
+  parallel_run(PARALLEL_OP_FILL, NULL, src, length, value, threads);
+  return src;
+}
+
+/**
+ * @brief Sets (length) bytes at (src) to zero on several threads
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to set to 0
+ * @param uint8_t threads - Number of threads, 0 for one per CPU
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_memzero_parallel(uint8_t * src, size_t length, uint8_t threads)
+{
+  return my_memset_parallel(src, length, 0, threads);
+}
+
+/**
+ * @brief Sets the size from which copies and fills run on several threads
+ *
+ * @param size_t threshold - Size in bytes, 0 never splits
+ */
+void set_parallel_threshold(size_t threshold)
+{
+  parallel_threshold = threshold;
+}
+
+/**
+ * @brief Returns the size from which copies and fills run on several threads
+ *
+ * @return - size in bytes, 0 if the automatic mode is off
+ */
+size_t get_parallel_threshold(void)
+{
+  return parallel_threshold;
+}
+
+/* Takes a block from the first backend that has one: attached pools, the
+ * arena, then the thread cache or malloc */
+static int32_t * reserve_backend(size_t length)
+{
+  int32_t * block;
+
+  if (pool_list != NULL)
+  {
+    block = pool_list_reserve(length);
+    if (block != NULL)
+    {
+      return block;
+    }
+  }
+  if (arena.base != NULL)
+  {
+    return arena_reserve(length);
+  }
+#ifdef MEMORY_THREAD_CACHE
+  return tcache_reserve(length);
+#else
+  return (int32_t * ) malloc(length*sizeof(int32_t));
+#endif
+}
+
+/**
+ * @brief Allocate in dynamic memory
+ *
+ * This should take number of words to allocate 
+ * in dynamic memory.
+ *
+ * @param size_t length - Number of words to reserve
+ *
+ * @return - a pointer to memory if successful,
+ *            or a Null Pointer if not successful
+ */
+int32_t * reserve_words(size_t length)
+{
+  int32_t * block = reserve_backend(length);
+
+  MEMORY_TRACE_RESERVE(block, length * sizeof(int32_t));
+  return block;
+}
+
+
+/**
+ * @brief Free a dynamic memory allocation 
+ *
+ * Should free a dynamic memory allocation by providing 
+ * the pointer src to the function
+ *
+ * @param size_t length - Number of words to reserve
+ */
+void free_words(int32_t * src)
+{
+  mem_pool_t * pool;
+
+  MEMORY_TRACE_FREE(src);
+  if (pool_list != NULL)
+  {
+    pool = pool_find_owner(src);
+    if (pool != NULL)
+    {
+      pool_free(pool, src);
+      return;
+    }
+  }
+  if (arena_owns(src))
+  {
+    arena_free(src);
+    return;
+  }
+  if (src == NULL)
+  {
+    return;
+  }
+#ifdef MEMORY_THREAD_CACHE
+  tcache_free(src);
+#else
+  free(src);
+#endif
+}
+
+/**
+ * @brief Grows a block from reserve_words to (new_length) words
+ *
+ * A block that already has room, or that can grow in place (the most
+ * recent arena block, a pool block with spare words, a malloc block that
+ * realloc extends), is kept. Otherwise a new block is reserved, the first
+ * (old_length) words are copied over and the old block is freed.
+ *
+ * @param int32_t * src - Block to grow, NULL to reserve a new one
+ * @param size_t old_length - Number of words to keep
+ * @param size_t new_length - Number of words needed
+ *
+ * @return - a pointer to the grown block, or a Null Pointer if there is
+ *           no memory, in which case (src) is left as it was
+ */
+int32_t * resize_words(int32_t * src, size_t old_length, size_t new_length)
+{
+  mem_pool_t * pool = NULL;
+  int32_t * block;
+
+  if (src == NULL)
+  {
+    return reserve_words(new_length);
+  }
+  if (new_length <= old_length)
+  {
+    return src;
+  }
+
+  if (pool_list != NULL)
+  {
+    pool = pool_find_owner(src);
+  }
+  if (pool != NULL)
+  {
+    if (new_length <= pool->block_words)
+    {
+      return src;
+    }
+  }
+  else if (arena_owns(src))
+  {
+    if (arena_grow(src, new_length))
+    {
+      MEMORY_TRACE_FREE(src);
+      MEMORY_TRACE_RESERVE(src, new_length * sizeof(int32_t));
+      return src;
+    }
+  }
+#ifndef MEMORY_THREAD_CACHE
+  else
+  {
+    /* plain malloc block: realloc can often extend it without a copy */
+    MEMORY_TRACE_FREE(src);
+    block = (int32_t *) realloc(src, new_length * sizeof(int32_t));
+    if (block == NULL)
+    {
+      MEMORY_TRACE_RESERVE(src, old_length * sizeof(int32_t));
+      return NULL;
+    }
+    MEMORY_TRACE_RESERVE(block, new_length * sizeof(int32_t));
+    return block;
+  }
+#endif
+
+  block = reserve_words(new_length);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+  my_memcopy((uint8_t *) src, (uint8_t *) block, old_length * sizeof(int32_t));
+  free_words(src);
+  return block;
+}
+
+/**
+ * @brief Reserves (length) words starting at a multiple of (alignment)
+ *
+ * The block comes from reserve_words with room for the alignment, and
+ * the pointer reserve_words returned is kept in the word before the
+ * aligned start.
+ *
+ * @param size_t length - Number of words to reserve
+ * @param size_t alignment - Alignment in bytes, a power of two
+ *
+ * @return - a pointer to the aligned memory, or a Null Pointer
+ */
+int32_t * reserve_words_aligned(size_t length, size_t alignment)
+{
+  int32_t * raw;
+  uintptr_t start;
+
+  if ((alignment & (alignment - 1)) != 0)
+  {
+    return NULL;
+  }
+  if (alignment < sizeof(void *))
+  {
+    alignment = sizeof(void *);
+  }
+
+  raw = reserve_words(length + (alignment + sizeof(void *)) / sizeof(int32_t));
+  if (raw == NULL)
+  {
+    return NULL;
+  }
+  start = ((uintptr_t) raw + sizeof(void *) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+  ((int32_t **) start)[-1] = raw;
+
+  return (int32_t *) start;
+}
+
+/**
+ * @brief Frees a block from reserve_words_aligned
+ *
+ * @param int32_t * src - Block to free, may be NULL
+ */
+void free_words_aligned(int32_t * src)
+{
+  if (src != NULL)
+  {
+    free_words(((int32_t **) src)[-1]);
+  }
+}
+
+#if defined (HOST)
+/* Head of a mapped block: one cache line in front of the data, so the
+ * data stays aligned for any vector width */
+#define LARGE_HEADER_BYTES (64)
+#define LARGE_HUGE_PAGE    (2UL * 1024UL * 1024UL)
+
+typedef struct
+{
+  void * map;     /* start of the mapping */
+  size_t bytes;   /* length of the mapping */
+  uint8_t flags;  /* MEM_LARGE_HUGE_PAGES or MEM_LARGE_THP if the mapping got them */
+} large_header_t;
+
+/* Maps (bytes) aligned to a huge page, trimming the rest of an oversized
+ * mapping, so transparent huge pages can back the whole block */
+static void * large_map_aligned(size_t bytes, int flags)
+{
+  uint8_t * map;
+  uintptr_t start;
+  size_t head;
+
+  map = mmap(NULL, bytes + LARGE_HUGE_PAGE, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (map == MAP_FAILED)
+  {
+    return MAP_FAILED;
+  }
+  start = ((uintptr_t) map + LARGE_HUGE_PAGE - 1) & ~(uintptr_t)(LARGE_HUGE_PAGE - 1);
+  head = start - (uintptr_t) map;
+  if (head != 0)
+  {
+    munmap(map, head);
+  }
+  munmap((uint8_t *) start + bytes, LARGE_HUGE_PAGE - head);
+  return (void *) start;
+}
+#endif
+
+/**
+ * @brief Reserves a large block straight from the operating system
+ *
+ * @param size_t length - Number of words to reserve
+ * @param uint8_t flags - MEM_LARGE_* flags
+ *
+ * @return - a pointer to memory aligned to 64 bytes, or a Null Pointer
+ */
+int32_t * reserve_words_large(size_t length, uint8_t flags)
+{
+#if defined (HOST)
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  size_t bytes = length * sizeof(int32_t) + LARGE_HEADER_BYTES;
+  int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void * map = MAP_FAILED;
+  uint8_t got = 0;
+  large_header_t * header;
+
+  if (flags & MEM_LARGE_POPULATE)
+  {
+    map_flags |= MAP_POPULATE;
+  }
+
+  if (flags & MEM_LARGE_HUGE_PAGES)
+  {
+    /* needs pages reserved in /proc/sys/vm/nr_hugepages */
+    bytes = (bytes + LARGE_HUGE_PAGE - 1) & ~(LARGE_HUGE_PAGE - 1);
+    map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, map_flags | MAP_HUGETLB, -1, 0);
+    got = MEM_LARGE_HUGE_PAGES;
+  }
+  if ((map == MAP_FAILED) && (flags & MEM_LARGE_THP))
+  {
+    bytes = (bytes + LARGE_HUGE_PAGE - 1) & ~(LARGE_HUGE_PAGE - 1);
+    /* populate after the hint, so the first fault already gets huge pages */
+    map = large_map_aligned(bytes, map_flags & ~MAP_POPULATE);
+    got = MEM_LARGE_THP;
+    if (map != MAP_FAILED)
+    {
+      madvise(map, bytes, MADV_HUGEPAGE);
+      if (flags & MEM_LARGE_POPULATE)
+      {
+        my_memzero((uint8_t *) map, bytes);
+      }
+    }
+  }
+  if (map == MAP_FAILED)
+  {
+    got = 0;
+    bytes = (bytes + page - 1) & ~(page - 1);
+    map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+  }
+  if (map == MAP_FAILED)
+  {
+    MEMORY_TRACE_RESERVE(NULL, 0);
+    return NULL;
+  }
+
+  header = (large_header_t *) map;
+  header->map = map;
+  header->bytes = bytes;
+  header->flags = got;
+  MEMORY_TRACE_RESERVE((int32_t *)((uint8_t *) map + LARGE_HEADER_BYTES), bytes);
+  return (int32_t *)((uint8_t *) map + LARGE_HEADER_BYTES);
+#else
+  (void) flags;
+  return reserve_words_aligned(length, 64);
+#endif
+}
+
+/**
+ * @brief Frees a block from reserve_words_large
+ *
+ * @param int32_t * src - Block to free, may be NULL
+ */
+void free_words_large(int32_t * src)
+{
+#if defined (HOST)
+  large_header_t * header;
+
+  if (src == NULL)
+  {
+    return;
+  }
+  MEMORY_TRACE_FREE(src);
+  header = (large_header_t *)((uint8_t *) src - LARGE_HEADER_BYTES);
+  munmap(header->map, header->bytes);
+#else
+  free_words_aligned(src);
+#endif
+}
+
+/**
+ * @brief Grows a block from reserve_words_large to (new_length) words
+ *
+ * On the host the mapping is grown with mremap, which extends it in place
+ * or moves its pages to a new address, so no data is copied. Mappings
+ * with huge pages keep their 2 MB alignment and hint.
+ *
+ * @param int32_t * src - Block to grow, NULL to map a new one
+ * @param size_t old_length - Number of words to keep
+ * @param size_t new_length - Number of words needed
+ *
+ * @return - a pointer to the grown block, or a Null Pointer if there is
+ *           no memory, in which case (src) is left as it was
+ */
+int32_t * resize_words_large(int32_t * src, size_t old_length, size_t new_length)
+{
+  int32_t * block;
+#if defined (HOST)
+  large_header_t * header;
+  size_t bytes = new_length * sizeof(int32_t) + LARGE_HEADER_BYTES;
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  void * map = MAP_FAILED;
+  void * target;
+
+  if (src == NULL)
+  {
+    return reserve_words_large(new_length, 0);
+  }
+  header = (large_header_t *)((uint8_t *) src - LARGE_HEADER_BYTES);
+  if (header->flags != 0)
+  {
+    page = LARGE_HUGE_PAGE;
+  }
+  bytes = (bytes + page - 1) & ~(page - 1);
+  if (bytes <= header->bytes)
+  {
+    return src;
+  }
+
+  if (header->flags & MEM_LARGE_THP)
+  {
+    /* move onto a 2 MB aligned placeholder, so huge pages still fit */
+    target = large_map_aligned(bytes, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+    if (target != MAP_FAILED)
+    {
+      map = mremap(header->map, header->bytes, bytes, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+      if (map == MAP_FAILED)
+      {
+        munmap(target, bytes);
+      }
+      else
+      {
+        madvise(map, bytes, MADV_HUGEPAGE);
+      }
+    }
+  }
+  else
+  {
+    map = mremap(header->map, header->bytes, bytes, MREMAP_MAYMOVE);
+  }
+
+  if (map != MAP_FAILED)
+  {
+    MEMORY_TRACE_FREE(src);
+    header = (large_header_t *) map;
+    header->map = map;
+    header->bytes = bytes;
+    block = (int32_t *)((uint8_t *) map + LARGE_HEADER_BYTES);
+    MEMORY_TRACE_RESERVE(block, bytes);
+    return block;
+  }
+
+  /* mremap refused (hugetlb on older kernels): copy */
+  block = reserve_words_large(new_length, header->flags);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+  my_memcopy((uint8_t *) src, (uint8_t *) block, old_length * sizeof(int32_t));
+  free_words_large(src);
+  return block;
+#else
+  if (src == NULL)
+  {
+    return reserve_words_large(new_length, 0);
+  }
+  if (new_length <= old_length)
+  {
+    return src;
+  }
+  block = reserve_words_large(new_length, 0);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+  my_memcopy((uint8_t *) src, (uint8_t *) block, old_length * sizeof(int32_t));
+  free_words_large(src);
+  return block;
+#endif
+}
+
+/**
+ * @brief Switches reserve_words/free_words to an arena
+ *
+ * @param int32_t * region - Memory for the arena, NULL to take it from malloc
+ * @param size_t length - Size of the region in words
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if no region could be set up
+ */
+int8_t arena_init(int32_t * region, size_t length)
+{
+  uint8_t owned = 0;
+
+  if (length == 0)
+  {
+    return MEM_ERROR;
+  }
+  if (region == NULL)
+  {
+    region = (int32_t *) malloc(length * sizeof(int32_t));
+    if (region == NULL)
+    {
+      return MEM_ERROR;
+    }
+    owned = 1;
+  }
+
+  arena_release();
+  arena.base = region;
+  arena.size = length;
+  arena.top = 0;
+  arena.last = 0;
+  arena.owned = owned;
+  return MEM_NO_ERROR;
+}
+
+/**
+ * @brief Returns the current top of the arena
+ *
+ * @return - number of words in use, to pass to arena_rewind()
+ */
+size_t arena_mark(void)
+{
+  return arena.top;
+}
+
+/**
+ * @brief Frees every arena block reserved after a mark
+ *
+ * @param size_t mark - Value returned by arena_mark()
+ */
+void arena_rewind(size_t mark)
+{
+  if (mark <= arena.top)
+  {
+    MEMORY_TRACE_FREE_RANGE(arena.base + mark, arena.base + arena.top);
+    arena.top = mark;
+    arena.last = mark;
+  }
+}
+
+/**
+ * @brief Frees all arena blocks at once
+ */
+void arena_reset(void)
+{
+  arena_rewind(0);
+}
+
+/**
+ * @brief Returns the number of arena words in use
+ *
+ * @return - words in use, 0 if the arena is off
+ */
+size_t arena_used(void)
+{
+  return arena.top;
+}
+
+/**
+ * @brief Turns the arena set up by arena_init() off
+ *
+ * Gives the region back to malloc if arena_init() took it from there.
+ * reserve_words goes back to malloc, or to the build-time arena.
+ */
+void arena_release(void)
+{
+  MEMORY_TRACE_FREE_RANGE(arena.base, arena.base + arena.top);
+  if (arena.owned)
+  {
+    free(arena.base);
+  }
+#ifdef MEMORY_ARENA_WORDS
+  arena.base = arena_static_region;
+  arena.size = MEMORY_ARENA_WORDS;
+#else
+  arena.base = NULL;
+  arena.size = 0;
+#endif
+  arena.top = 0;
+  arena.last = 0;
+  arena.owned = 0;
+}
+
+
+/**
+ * @brief Copies the allocation counters of an instrumented build
+ *
+ * @param mem_stats_t * stats - Where to copy the counters
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if the build is not instrumented
+ */
+int8_t memory_get_stats(mem_stats_t * stats)
+{
+#ifdef MEMORY_INSTRUMENT
+  TRACE_LOCK();
+  *stats = trace_stats;
+  TRACE_UNLOCK();
+  return MEM_NO_ERROR;
+#else
+  (void) stats;
+  return MEM_ERROR;
+#endif
+}
+
+/**
+ * @brief Resets the call counters and the histogram, and sets the peak
+ * to the bytes in flight now
+ */
+void memory_reset_stats(void)
+{
+#ifdef MEMORY_INSTRUMENT
+  size_t bucket;
+
+  TRACE_LOCK();
+  trace_stats.reserve_calls = 0;
+  trace_stats.free_calls = 0;
+  trace_stats.failed_reserves = 0;
+  trace_stats.peak_bytes = trace_stats.bytes_in_flight;
+  for (bucket = 0; bucket < MEM_STATS_BUCKETS; bucket++)
+  {
+    trace_stats.size_histogram[bucket] = 0;
+  }
+  TRACE_UNLOCK();
+#endif
+}
+
+/**
+ * @brief Prints every block reserved and not freed yet
+ *
+ * @return - number of outstanding blocks
+ */
+size_t memory_dump_outstanding(void)
+{
+#ifdef MEMORY_INSTRUMENT
+  size_t i;
+  size_t blocks;
+
+  TRACE_LOCK();
+  blocks = trace_stats.blocks_in_flight;
+  if (blocks != 0)
+  {
+    PRINTF("memory: %lu blocks, %lu bytes outstanding\n",
+           (unsigned long) blocks, (unsigned long) trace_stats.bytes_in_flight);
+    for (i = 0; i < trace_slots; i++)
+    {
+      if ((trace_table[i].block != NULL) && (trace_table[i].block != TRACE_TOMBSTONE))
+      {
+        PRINTF("  %p: %lu bytes\n", (void *) trace_table[i].block,
+               (unsigned long) trace_table[i].bytes);
+      }
+    }
+  }
+  TRACE_UNLOCK();
+  return blocks;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Sets up a pool of fixed-size blocks
+ *
+ * @param mem_pool_t * pool - Pool to set up
+ * @param int32_t * storage - Memory for the blocks, NULL to reserve it
+ * @param size_t block_words - Size of one block in words
+ * @param size_t block_count - Number of blocks
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory for the pool
+ */
+int8_t pool_init(mem_pool_t * pool, int32_t * storage, size_t block_words, size_t block_count)
+{
+  if ((pool == NULL) || (block_words == 0) || (block_count == 0))
+  {
+    return MEM_ERROR;
+  }
+
+  /* a free block holds the link to the next one, and every block stays
+     aligned for that link */
+  block_words = (block_words + POOL_LINK_WORDS - 1) / POOL_LINK_WORDS * POOL_LINK_WORDS;
+
+  pool->owned = 0;
+  if (storage == NULL)
+  {
+    storage = reserve_words(block_words * block_count);
+    if (storage == NULL)
+    {
+      return MEM_ERROR;
+    }
+    pool->owned = 1;
+  }
+
+  pool->storage = storage;
+  pool->block_words = block_words;
+  pool->block_count = block_count;
+  pool->free_list = NULL;
+  pool->untouched = 0;
+  pool->in_use = 0;
+  pool->peak = 0;
+  pool->next = NULL;
+  pool->attached = 0;
+  return MEM_NO_ERROR;
+}
+
+/**
+ * @brief Takes one block from a pool
+ *
+ * @param mem_pool_t * pool - Pool to take the block from
+ *
+ * @return - a pointer to the block, or a Null Pointer if the pool is empty
+ */
+int32_t * pool_reserve(mem_pool_t * pool)
+{
+  int32_t * block;
+
+  if (pool->free_list != NULL)
+  {
+    /* most recently freed block first - it is likely still in cache */
+    block = (int32_t *) pool->free_list;
+    pool->free_list = *(void **) block;
+  }
+  else if (pool->untouched < pool->block_count)
+  {
+    /* blocks never used before are handed out in order, so pool_init
+       does not have to walk the whole storage to build the free list */
+    block = pool->storage + pool->untouched * pool->block_words;
+    pool->untouched++;
+  }
+  else
+  {
+    return NULL;
+  }
+
+  pool->in_use++;
+  if (pool->in_use > pool->peak)
+  {
+    pool->peak = pool->in_use;
+  }
+  return block;
+}
+
+/**
+ * @brief Gives a block back to its pool
+ *
+ * @param mem_pool_t * pool - Pool the block was taken from
+ * @param int32_t * block - Block to give back
+ */
+void pool_free(mem_pool_t * pool, int32_t * block)
+{
+  if ((block == NULL) || (! pool_owns(pool, block)))
+  {
+    return;
+  }
+
+  *(void **) block = pool->free_list;
+  pool->free_list = block;
+  pool->in_use--;
+}
+
+/**
+ * @brief Routes reserve_words/free_words of fitting sizes to a pool
+ *
+ * @param mem_pool_t * pool - Pool set up by pool_init()
+ */
+void pool_attach(mem_pool_t * pool)
+{
+  mem_pool_t ** link = &pool_list;
+
+  if (pool->attached)
+  {
+    return;
+  }
+
+  /* keep the list sorted so the first fit is the best fit */
+  while ((*link != NULL) && ((*link)->block_words <= pool->block_words))
+  {
+    link = &(*link)->next;
+  }
+  pool->next = *link;
+  *link = pool;
+  pool->attached = 1;
+}
+
+/**
+ * @brief Stops routing reserve_words/free_words to a pool
+ *
+ * @param mem_pool_t * pool - Pool attached by pool_attach()
+ */
+void pool_detach(mem_pool_t * pool)
+{
+  mem_pool_t ** link = &pool_list;
+
+  while (*link != NULL)
+  {
+    if (*link == pool)
+    {
+      *link = pool->next;
+      break;
+    }
+    link = &(*link)->next;
+  }
+  pool->next = NULL;
+  pool->attached = 0;
+}
+
+/**
+ * @brief Detaches a pool and frees its storage if pool_init() reserved it
+ *
+ * @param mem_pool_t * pool - Pool to destroy
+ */
+void pool_destroy(mem_pool_t * pool)
+{
+  pool_detach(pool);
+  if (pool->owned)
+  {
+    free_words(pool->storage);
+  }
+  pool->storage = NULL;
+  pool->block_count = 0;
+  pool->free_list = NULL;
+  pool->untouched = 0;
+  pool->in_use = 0;
+  pool->owned = 0;
+}
+
+/**
+ * @brief Returns the number of blocks of a pool in use
+ *
+ * @param const mem_pool_t * pool - Pool to query
+ *
+ * @return - blocks in use
+ */
+size_t pool_in_use(const mem_pool_t * pool)
+{
+  return pool->in_use;
 }
 
-void clear_value(char * ptr, unsigned int index){
-  set_value(ptr, index, 0);
+/**
+ * @brief Returns the highest number of blocks of a pool in use at once
+ *
+ * @param const mem_pool_t * pool - Pool to query
+ *
+ * @return - peak of blocks in use
+ */
+size_t pool_peak(const mem_pool_t * pool)
+{
+  return pool->peak;
 }
 
-char get_value(char * ptr, unsigned int index){
-  return ptr[index];
+/**
+ * @brief Reverse the order of all of the bytes
+ *
+ * This should take a pointer to a memory location 
+ * and a length in bytes and reverse the order of all of the bytes.
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to reverse
+ *
+ * @return - a pointer to the source (src)
+ */
+uint8_t * my_reverse(uint8_t * src, size_t length)
+{
+  /* in place, no help memory: blocks are swapped from both ends */
+  reverse_kernel(src, length);
+
+  return src;
 }
 
-void set_all(char * ptr, char value, unsigned int size){
-  unsigned int i;
-  for(i = 0; i < size; i++) {
-    set_value(ptr, i, value);
+/* The shorter side of a rotation up to this size goes through a stack
+ * buffer, so the rest is moved once by my_memmove */
+#if defined (MSP432)
+  #define ROTATE_BUFFER_B  (64)
+#else
+  #define ROTATE_BUFFER_B  (256)
+#endif
+
+/* With vector reversal kernels, three reversals beat block swaps at every
+ * size. The word kernels reverse at about the speed they swap, so there
+ * the block swaps, which pass over the data only once, win. */
+#ifdef MEMORY_X86_SIMD
+  #define ROTATE_BY_REVERSAL
+#endif
+
+/* Rotates [A B] into [B A] when A or B fits in ROTATE_BUFFER_B */
+static void rotate_buffered(uint8_t * src, size_t left, size_t right)
+{
+  uint8_t tmp[ROTATE_BUFFER_B];
+
+  if (left <= right)
+  {
+    my_memcopy(src, tmp, left);
+    my_memmove(src + left, src, right);
+    my_memcopy(tmp, src + right, left);
+  }
+  else
+  {
+    my_memcopy(src + left, tmp, right);
+    my_memmove(src, src + right, left);
+    my_memcopy(tmp, src, right);
   }
 }
 
-void clear_all(char * ptr, unsigned int size){
-  set_all(ptr, 0, size);
+#ifndef ROTATE_BY_REVERSAL
+/* Exchanges (length) bytes at (a) and (b), the regions do not overlap */
+static void rotate_swap(uint8_t * a, uint8_t * b, size_t length)
+{
+  mem_word_t t;
+  uint8_t c;
+
+  while (length >= MEM_WORD_SIZE)
+  {
+    t = ((mem_uword_t *) a)->w;
+    ((mem_uword_t *) a)->w = ((mem_uword_t *) b)->w;
+    ((mem_uword_t *) b)->w = t;
+    a += MEM_WORD_SIZE;
+    b += MEM_WORD_SIZE;
+    length -= MEM_WORD_SIZE;
+  }
+  while (length-- != 0)
+  {
+    c = *a;
+    *a++ = *b;
+    *b++ = c;
+  }
 }
 
-/************************** my FUNCTIONS*********************/
+/* Gries-Mills block swap: swapping the shorter side with the far end of
+ * the longer one puts it in its final place and leaves a smaller rotation
+ * of the rest. The tail of that, once one side is short, is buffered. */
+static void rotate_block_swap(uint8_t * src, size_t left, size_t right)
+{
+  while ((left > ROTATE_BUFFER_B) && (right > ROTATE_BUFFER_B))
+  {
+    if (left <= right)
+    {
+      /* [A B1 B2] -> [B2 B1 A] */
+      rotate_swap(src, src + right, left);
+      right -= left;
+    }
+    else
+    {
+      /* [A1 A2 B] -> [B A2 A1] */
+      rotate_swap(src, src + left, right);
+      src += right;
+      left -= right;
+    }
+  }
+  if ((left != 0) && (right != 0))
+  {
+    rotate_buffered(src, left, right);
+  }
+}
+#endif
 
 /**
- * @brief Moves (length) bytes from (src) to (dest) 
- *
- * The behavior should handle overlap of source and destination. 
- * Copy should occur, with no data corruption.
+ * @brief Rotates (length) bytes in place so byte (shift) comes first
  *
  * @param uint8_t * src - Pointer to source
- * @param uint8_t * dst - Pointer to destination
- * @param size_t length - Number of bytes to move
+ * @param size_t length - Number of bytes to rotate
+ * @param size_t shift - Bytes to rotate to the left, taken modulo length
  *
- * @return - a pointer to the destination (dst)
+ * @return - a pointer to the source (src)
  */
-uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length)
+uint8_t * my_rotate(uint8_t * src, size_t length, size_t shift)
 {
-  size_t i;
-  uint8_t *s;
-  uint8_t *d;
+  size_t right;
 
-  if (dst == src) {return dst;}
+  if (length == 0)
+  {
+    return src;
+  }
+  shift %= length;
+  right = length - shift;
+  if (shift == 0)
+  {
+    return src;
+  }
 
-  if ( dst > src )
+  if ((shift <= ROTATE_BUFFER_B) || (right <= ROTATE_BUFFER_B))
   {
-    /* Handles the situation when src is the first block but dst 
-    overlaps it. In this case copying from the first element to the last 
-    will corrupt data. Copying from the last to the first is required */
-    i = length;
-    d = dst + length - 1;
-    s = src + length - 1;
-    while (i > 0)
-    {
-      *d = *s;
-      --d;
-      --s;
-      --i;
-    }
-    /* other variant:
-     * i = len; d =dst+len; s=src+len;
-     * while (--i) { *(--d) = * (--s); } 
-     */
+    rotate_buffered(src, shift, right);
   }
   else
   {
-    /* we should copy from start to end - it handles not-overlapped src and dst
-    and it handles overlapping, when dst if the first memory block by it's address */
-    i = 0;
-    d = dst;
-    s = src;
-    while (i < length)
-    {
-      *d = *s;
-      d++;
-      s++;
-      i++;
-    }
+#ifdef ROTATE_BY_REVERSAL
+    /* [A B] -> [A' B'] -> [B A] */
+    my_reverse(src, shift);
+    my_reverse(src + shift, right);
+    my_reverse(src, length);
+#else
+    rotate_block_swap(src, shift, right);
+#endif
   }
 
+  return src;
+}
+
+/**
+ * @brief Swaps the bytes of (count) 16 bit values
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 16 bit values
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_bswap16(uint8_t * src, uint8_t * dst, size_t count)
+{
+  bswap_kernel(dst, src, count * 2, 2);
   return dst;
+}
 
+/**
+ * @brief Swaps the bytes of (count) 32 bit values
+ *
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 32 bit values
+ *
+ * @return - a pointer to the destination (dst)
+ */
+uint8_t * my_bswap32(uint8_t * src, uint8_t * dst, size_t count)
+{
+  bswap_kernel(dst, src, count * 4, 4);
+  return dst;
 }
 
 /**
- * @brief Copies (length) bytes from (src) to (dest) 
- * 
- * The behavior is undefined if there is overlap of source and 
- * destination. Copy should still occur, but will likely corrupt
- * your data.
+ * @brief Swaps the bytes of (count) 64 bit values
  *
- * @param uint8_t * src - Pointer to source
- * @param uint8_t * dst - Pointer to destination
- * @param size_t length - Number of bytes to copy
+ * @param uint8_t * src - Source address
+ * @param uint8_t * dst - Destination address, may be equal to src
+ * @param size_t count - Number of 64 bit values
  *
  * @return - a pointer to the destination (dst)
  */
-uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length)
+uint8_t * my_bswap64(uint8_t * src, uint8_t * dst, size_t count)
 {
-  uint8_t * dst_orig = dst;
+  bswap_kernel(dst, src, count * 8, 8);
+  return dst;
+}
 
-  while (length != 0)
-  {
-    *dst=*src;
-    dst++;
-    src++;
-    length--;
-  }
-  return dst_orig;
+/**
+ * @brief Finds the first byte where two buffers differ
+ *
+ * @param uint8_t * src1 - First buffer
+ * @param uint8_t * src2 - Second buffer
+ * @param size_t length - Number of bytes to compare
+ *
+ * @return - index of the first differing byte, or (length) if equal
+ */
+size_t my_mismatch(uint8_t * src1, uint8_t * src2, size_t length)
+{
+  return mismatch_kernel(src1, src2, length);
 }
 
 /**
- * @brief Set all (length) bytes at address (src) to a given (value)
+ * @brief Compares two buffers byte by byte, as unsigned values
  *
- * @param uint8_t * src - Pointer to source
- * @param size_t length - Number of bytes to set to a value
- * @param uint8_t value - Value to be set
+ * @param uint8_t * src1 - First buffer
+ * @param uint8_t * src2 - Second buffer
+ * @param size_t length - Number of bytes to compare
  *
- * @return - a pointer to the source (src)
+ * @return - 0 if equal, otherwise the difference of the first differing bytes
  */
-uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value)
+int32_t my_memcmp(uint8_t * src1, uint8_t * src2, size_t length)
 {
-  uint8_t * ptr = src;  
+  size_t i = mismatch_kernel(src1, src2, length);
 
-  while (length != 0 )
+  if (i == length)
   {
-    *ptr = value;
-    ptr++;
-    length--;
+    return 0;
   }
+  return (int32_t) src1[i] - (int32_t) src2[i];
+}
 
-  return src;
+/**
+ * @brief Finds the first byte with a given (value)
+ *
+ * @param uint8_t * src - Pointer to source
+ * @param size_t length - Number of bytes to search
+ * @param uint8_t value - Value to look for
+ *
+ * @return - a pointer to the byte, or NULL if there is none
+ */
+uint8_t * my_memchr(uint8_t * src, size_t length, uint8_t value)
+{
+  size_t i = find_kernel(src, length, value);
+
+  return (i == length) ? NULL : (src + i);
 }
 
 /**
- * @brief Set all (length) bytes at address (src) to a zero
+ * @brief Finds the last byte with a given (value)
  *
  * @param uint8_t * src - Pointer to source
- * @param size_t length - Number of bytes to set to 0
+ * @param size_t length - Number of bytes to search
+ * @param uint8_t value - Value to look for
  *
- * @return - a pointer to the source (src)
+ * @return - a pointer to the byte, or NULL if there is none
  */
-uint8_t * my_memzero(uint8_t * src, size_t length)
+uint8_t * my_memrchr(uint8_t * src, size_t length, uint8_t value)
 {
-  return my_memset(src,length,0);
+  size_t i = find_last_kernel(src, length, value);
+
+  return (i == length) ? NULL : (src + i);
+}
+
+/***********************************************************
+ Buffer slices
+***********************************************************/
+
+/* Head of a backing block, the data follows it. Two words, so the data
+ * keeps the alignment of the block on both platforms. */
+struct mem_slice_block
+{
+  size_t refs;     /* slices holding the block */
+  size_t length;   /* data bytes reserved */
 };
 
+static mem_slice_t slice_empty(void)
+{
+  mem_slice_t slice = { NULL, NULL, 0 };
+
+  return slice;
+}
+
 /**
- * @brief Allocate in dynamic memory
+ * @brief Reserves a new backing block and returns a slice of all of it
  *
- * This should take number of words to allocate 
- * in dynamic memory.
+ * @param size_t length - Number of data bytes
  *
- * @param size_t length - Number of words to reserve
+ * @return - the slice, an empty slice (data NULL) if there is no memory
+ */
+mem_slice_t slice_reserve(size_t length)
+{
+  mem_slice_t slice;
+  size_t words = (sizeof(struct mem_slice_block) + length + sizeof(int32_t) - 1) / sizeof(int32_t);
+
+  slice.block = (struct mem_slice_block *) reserve_words(words);
+  if (slice.block == NULL)
+  {
+    return slice_empty();
+  }
+  slice.block->refs = 1;
+  slice.block->length = length;
+  slice.data = (uint8_t *)(slice.block + 1);
+  slice.length = length;
+
+  return slice;
+}
+
+/**
+ * @brief Returns a slice of (length) bytes at (offset) inside (parent)
  *
- * @return - a pointer to memory if successful,
- *            or a Null Pointer if not successful
+ * @param mem_slice_t parent - Slice to take the view from
+ * @param size_t offset - Start of the view inside the parent
+ * @param size_t length - Number of bytes of the view
+ *
+ * @return - the slice, an empty slice if the range is not inside the parent
  */
-int32_t * reserve_words(size_t length)
+mem_slice_t slice_sub(mem_slice_t parent, size_t offset, size_t length)
 {
-  return (int32_t * ) malloc(length*sizeof(int32_t));
+  if ((parent.block == NULL) || (offset > parent.length) || (length > parent.length - offset))
+  {
+    return slice_empty();
+  }
+  parent = slice_retain(parent);
+  parent.data += offset;
+  parent.length = length;
+
+  return parent;
+}
+
+/**
+ * @brief Takes one more reference for a copy of (slice)
+ *
+ * @param mem_slice_t slice - Slice to share
+ *
+ * @return - the same view, holding its own reference
+ */
+mem_slice_t slice_retain(mem_slice_t slice)
+{
+  if (slice.block != NULL)
+  {
+    __atomic_fetch_add(&slice.block->refs, 1, __ATOMIC_RELAXED);
+  }
+  return slice;
 }
 
+/**
+ * @brief Gives a reference back and empties the slice
+ *
+ * @param mem_slice_t * slice - Slice to release
+ */
+void slice_release(mem_slice_t * slice)
+{
+  if (slice->block != NULL)
+  {
+    /* the last owner has to see every write made through the others */
+    if (__atomic_sub_fetch(&slice->block->refs, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+      free_words((int32_t *) slice->block);
+    }
+  }
+  *slice = slice_empty();
+}
 
 /**
- * @brief Free a dynamic memory allocation 
+ * @brief Returns the number of slices sharing the block of (slice)
  *
- * Should free a dynamic memory allocation by providing 
- * the pointer src to the function
+ * @param mem_slice_t slice - Slice to query
  *
- * @param size_t length - Number of words to reserve
+ * @return - references to the backing block, 0 for an empty slice
  */
-void free_words(int32_t * src)
+size_t slice_refs(mem_slice_t slice)
 {
-  free(src);
+  if (slice.block == NULL)
+  {
+    return 0;
+  }
+  return __atomic_load_n(&slice.block->refs, __ATOMIC_RELAXED);
 }
 
+/***********************************************************
+ Word buffers
+***********************************************************/
+
+/* Capacity of the first reservation of an empty buffer */
+#define WORDBUF_MIN_WORDS (16)
 
 /**
- * @brief Reverse the order of all of the bytes
+ * @brief Sets up an empty word buffer, nothing is reserved yet
  *
- * This should take a pointer to a memory location 
- * and a length in bytes and reverse the order of all of the bytes.
+ * @param mem_wordbuf_t * buf - Buffer to set up
+ */
+void wordbuf_init(mem_wordbuf_t * buf)
+{
+  buf->data = NULL;
+  buf->length = 0;
+  buf->capacity = 0;
+  buf->large = 0;
+}
+
+/**
+ * @brief Makes room for at least (capacity) words
  *
- * @param uint8_t * src - Pointer to source
- * @param size_t length - Number of bytes to reverse
+ * @param mem_wordbuf_t * buf - Buffer to grow
+ * @param size_t capacity - Number of words needed
  *
- * @return - a pointer to the source (src)
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory, in which
+ *           case the buffer is left as it was
  */
-uint8_t * my_reverse(uint8_t * src, size_t length)
+int8_t wordbuf_reserve(mem_wordbuf_t * buf, size_t capacity)
 {
-  size_t const half_length = length / 2.0; // length of help memory required
+  size_t grown;
+  int32_t * data;
 
-  uint8_t help_mem[half_length]; // additional memory to help reversing 
-  uint8_t* dst_ptr;
-  uint8_t* src_ptr;
-  
-  size_t i;
+  if (capacity <= buf->capacity)
+  {
+    return MEM_NO_ERROR;
+  }
 
-  /* copy firts half or the source memory to help memory */
-  dst_ptr = help_mem;
-  src_ptr = src;
-  i = 0;
-  while (i < half_length)
-  {
-    *dst_ptr = *src_ptr;
-    dst_ptr++;
-    src_ptr++;
-    i++;  
-  }
-  
-  /* copy in reverse order second half or source memory 
-     to the first half of source memory  */
-  src_ptr = src + length - 1; //put source pointer to the last element
-  dst_ptr = src;
-  i = 0;
-  while (i < half_length)
+  /* doubling keeps the copies, and the remaps, to O(1) per word */
+  grown = (buf->capacity < WORDBUF_MIN_WORDS) ? WORDBUF_MIN_WORDS : buf->capacity * 2;
+  if (grown < capacity)
   {
-    *dst_ptr = *src_ptr;
-    dst_ptr++;
-    src_ptr--;
-    i++;  
+    grown = capacity;
   }
 
-  /* copy in reverse order first half or source memory,
-  saved in the help_mem to the second half of source memory  */
-  src_ptr = help_mem; 
-  dst_ptr = src + length -1; //put destination pointer to the last element
-  i = 0;
-  while (i < half_length)
+  if (buf->large)
+  {
+    data = resize_words_large(buf->data, buf->length, grown);
+  }
+  else if (grown >= MEMORY_WORDBUF_LARGE_WORDS)
+  {
+    /* the one copy of the buffer's life, from here on it is remapped */
+    data = reserve_words_large(grown, 0);
+    if (data != NULL)
+    {
+      my_memcopy((uint8_t *) buf->data, (uint8_t *) data, buf->length * sizeof(int32_t));
+      free_words(buf->data);
+      buf->large = 1;
+    }
+  }
+  else
   {
-    *dst_ptr = *src_ptr;
-    dst_ptr--;
-    src_ptr++;
-    i++;  
+    data = resize_words(buf->data, buf->length, grown);
   }
 
-return src;
-  
-}
\ No newline at end of file
+  if (data == NULL)
+  {
+    return MEM_ERROR;
+  }
+  buf->data = data;
+  buf->capacity = grown;
+  return MEM_NO_ERROR;
+}
+
+/**
+ * @brief Sets the number of words in use, growing the buffer if needed
+ *
+ * @param mem_wordbuf_t * buf - Buffer to resize
+ * @param size_t length - New number of words, added words are not set
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory
+ */
+int8_t wordbuf_resize(mem_wordbuf_t * buf, size_t length)
+{
+  if (wordbuf_reserve(buf, length) != MEM_NO_ERROR)
+  {
+    return MEM_ERROR;
+  }
+  buf->length = length;
+  return MEM_NO_ERROR;
+}
+
+/**
+ * @brief Adds (count) words at the end of the buffer
+ *
+ * @param mem_wordbuf_t * buf - Buffer to add to
+ * @param const int32_t * words - Words to add
+ * @param size_t count - Number of words
+ *
+ * @return - MEM_NO_ERROR, or MEM_ERROR if there is no memory
+ */
+int8_t wordbuf_append(mem_wordbuf_t * buf, const int32_t * words, size_t count)
+{
+  if (wordbuf_reserve(buf, buf->length + count) != MEM_NO_ERROR)
+  {
+    return MEM_ERROR;
+  }
+  my_memcopy((uint8_t *) words, (uint8_t *)(buf->data + buf->length), count * sizeof(int32_t));
+  buf->length += count;
+  return MEM_NO_ERROR;
+}
+
+/**
+ * @brief Frees the words of a buffer and leaves it empty
+ *
+ * @param mem_wordbuf_t * buf - Buffer to free
+ */
+void wordbuf_free(mem_wordbuf_t * buf)
+{
+  if (buf->large)
+  {
+    free_words_large(buf->data);
+  }
+  else
+  {
+    free_words(buf->data);
+  }
+  wordbuf_init(buf);
+}
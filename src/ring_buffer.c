@@ -0,0 +1,185 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file ring_buffer.c
+ * @brief Lock-free byte ring buffer for one producer and one consumer
+ *
+ * Each side owns one index and publishes it with a release store after
+ * the data is in place; the other side reads it with an acquire load
+ * before touching the data. The other side's index is only read again
+ * when the cached copy says there is not enough room or data.
+ *
+ * @author Oksana Vynokurova
+ * @date 11/2024
+ *
+ */
+#include "ring_buffer.h"
+#include "memory.h"
+
+#define RING_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+int8_t ring_init(ring_buffer_t * ring, uint8_t * storage, size_t capacity)
+{
+  if ((capacity == 0) || ((capacity & (capacity - 1)) != 0))
+  {
+    return MEM_ERROR;
+  }
+
+  ring->owned = 0;
+  if (storage == NULL)
+  {
+    storage = (uint8_t *) reserve_words((capacity + sizeof(int32_t) - 1) / sizeof(int32_t));
+    if (storage == NULL)
+    {
+      return MEM_ERROR;
+    }
+    ring->owned = 1;
+  }
+
+  ring->storage = storage;
+  ring->mask = capacity - 1;
+  ring->head = 0;
+  ring->tail_seen = 0;
+  ring->tail = 0;
+  ring->head_seen = 0;
+
+  return MEM_NO_ERROR;
+}
+
+void ring_destroy(ring_buffer_t * ring)
+{
+  if (ring->owned)
+  {
+    free_words((int32_t *) ring->storage);
+  }
+  ring->storage = NULL;
+  ring->owned = 0;
+}
+
+size_t ring_used(ring_buffer_t * ring)
+{
+  size_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+
+  return RING_LOAD_ACQUIRE(&ring->head) - tail;
+}
+
+size_t ring_free(ring_buffer_t * ring)
+{
+  return ring->mask + 1 - ring_used(ring);
+}
+
+/* Free bytes as seen by the producer, refreshing the tail only if needed */
+static size_t ring_room(ring_buffer_t * ring, size_t head, size_t wanted)
+{
+  size_t room = ring->mask + 1 - (head - ring->tail_seen);
+
+  if (room < wanted)
+  {
+    ring->tail_seen = RING_LOAD_ACQUIRE(&ring->tail);
+    room = ring->mask + 1 - (head - ring->tail_seen);
+  }
+  return room;
+}
+
+/* Readable bytes as seen by the consumer, refreshing the head only if needed */
+static size_t ring_data(ring_buffer_t * ring, size_t tail, size_t wanted)
+{
+  size_t data = ring->head_seen - tail;
+
+  if (data < wanted)
+  {
+    ring->head_seen = RING_LOAD_ACQUIRE(&ring->head);
+    data = ring->head_seen - tail;
+  }
+  return data;
+}
+
+size_t ring_write(ring_buffer_t * ring, uint8_t * src, size_t length)
+{
+  size_t head = ring->head;
+  size_t offset = head & ring->mask;
+  size_t first;
+  size_t room = ring_room(ring, head, length);
+
+  if (length > room)
+  {
+    length = room;
+  }
+
+  /* up to the end of the storage, then the rest from its start */
+  first = ring->mask + 1 - offset;
+  if (first > length)
+  {
+    first = length;
+  }
+  my_memcopy(src, ring->storage + offset, first);
+  my_memcopy(src + first, ring->storage, length - first);
+
+  RING_STORE_RELEASE(&ring->head, head + length);
+  return length;
+}
+
+size_t ring_read(ring_buffer_t * ring, uint8_t * dst, size_t length)
+{
+  size_t tail = ring->tail;
+  size_t offset = tail & ring->mask;
+  size_t first;
+  size_t data = ring_data(ring, tail, length);
+
+  if (length > data)
+  {
+    length = data;
+  }
+
+  first = ring->mask + 1 - offset;
+  if (first > length)
+  {
+    first = length;
+  }
+  my_memcopy(ring->storage + offset, dst, first);
+  my_memcopy(ring->storage, dst + first, length - first);
+
+  RING_STORE_RELEASE(&ring->tail, tail + length);
+  return length;
+}
+
+uint8_t * ring_write_peek(ring_buffer_t * ring, size_t * length)
+{
+  size_t head = ring->head;
+  size_t offset = head & ring->mask;
+  size_t contiguous = ring->mask + 1 - offset;
+  size_t room = ring_room(ring, head, contiguous);
+
+  *length = (room < contiguous) ? room : contiguous;
+  return ring->storage + offset;
+}
+
+void ring_write_commit(ring_buffer_t * ring, size_t length)
+{
+  RING_STORE_RELEASE(&ring->head, ring->head + length);
+}
+
+uint8_t * ring_read_peek(ring_buffer_t * ring, size_t * length)
+{
+  size_t tail = ring->tail;
+  size_t offset = tail & ring->mask;
+  size_t contiguous = ring->mask + 1 - offset;
+  size_t data = ring_data(ring, tail, contiguous);
+
+  *length = (data < contiguous) ? data : contiguous;
+  return ring->storage + offset;
+}
+
+void ring_read_commit(ring_buffer_t * ring, size_t length)
+{
+  RING_STORE_RELEASE(&ring->tail, ring->tail + length);
+}
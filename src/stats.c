@@ -30,6 +30,7 @@
 #include <stdbool.h>
 #include <stdlib.h> 
 #include "stats.h"
+#include "memory.h"
 #include "platform.h"
 
 
@@ -75,7 +76,7 @@ void quick_sort_recursive(unsigned char* arr, int start_idx, int finish_idx);
  * This subarrays (branches) are supposed to be sorted from biggest to smallest
  * As a result it writes down into the same arr[start_idx, finish_idx]
  * all values from both branches in sort order from biggest to smallest.
- * This funstion uses malloc/free.
+ * This funstion uses reserve_words/free_words.
  * 
  * @param unsigned char* arr - array to sort (partlially)
  * @param start_idx - index of the first element of the 1st subarray to sort
@@ -373,7 +374,7 @@ void sort_bubble (unsigned char* arr, int arr_length)
  * This subarrays (branches) are supposed to be sorted from biggest to smallest
  * As a result it writes down into the same arr[start_idx, finish_idx]
  * all values from both branches in sort order from biggest to smallest.
- * This funstion uses malloc/free.
+ * This funstion uses reserve_words/free_words.
  */
 void mergesort_merge(unsigned char* arr, int start_idx, int middle_idx, int finish_idx)
 {
@@ -386,7 +387,8 @@ void mergesort_merge(unsigned char* arr, int start_idx, int middle_idx, int fini
   j = middle_idx+1; //index for the second branch to merge
 
   // we need to allocate memory for temporary array of sorted elements
-  sorted_arr = (unsigned char*) malloc(sizeof(char) * (finish_idx - start_idx + 1) );
+  // (rounded up to whole words)
+  sorted_arr = (unsigned char*) reserve_words( (finish_idx - start_idx + sizeof(int32_t)) / sizeof(int32_t) );
   if (sorted_arr == NULL) {return;}
   
   k=0;
@@ -422,7 +424,7 @@ void mergesort_merge(unsigned char* arr, int start_idx, int middle_idx, int fini
     
   copy_ch_arr(sorted_arr, &arr[start_idx], finish_idx-start_idx +1);
 
-  free(sorted_arr);
+  free_words((int32_t*) sorted_arr);
 }
 
 /**This function is used by Merge sort algorythm 